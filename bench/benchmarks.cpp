@@ -0,0 +1,188 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <span>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "../include/bf.hpp"
+
+namespace {
+
+// Number of distinct keys per key type. The keys are reused cyclically, and there are enough of
+// them for the probes of large filters to miss the cache.
+constexpr std::size_t pool_size = 1 << 20;
+// Number of keys per call of the batched benchmarks.
+constexpr std::size_t batch = 4096;
+
+using Short = std::integral_constant<std::size_t, 8>;
+using Long = std::integral_constant<std::size_t, 64>;
+
+/**
+ * @brief Generates a pool of random keys.
+ * @param seed Seed of the generator, so that keys for inserting and for searching are disjoint.
+ */
+template <typename Key>
+auto keys(const std::uint64_t seed) {
+    auto gen = std::mt19937_64{seed};
+    if constexpr (std::is_same_v<Key, int>) {
+        auto res = std::vector<int>(pool_size);
+        for (auto& key : res) {
+            key = static_cast<int>(gen());
+        }
+        return res;
+    } else {
+        auto res = std::vector<std::string>(pool_size);
+        auto dist = std::uniform_int_distribution<int>{'a', 'z'};
+        for (auto& key : res) {
+            key.resize(Key::value);
+            for (auto& chr : key) {
+                chr = static_cast<char>(dist(gen));
+            }
+        }
+        return res;
+    }
+}
+
+template <typename Key>
+auto inserted() -> const auto& {
+    static const auto res = keys<Key>(1);
+    return res;
+}
+
+template <typename Key>
+auto searched() -> const auto& {
+    static const auto res = keys<Key>(2);
+    return res;
+}
+
+/**
+ * @brief Builds a filter for the benchmark arguments once and shares it between the threads and
+ * the repetitions of the search benchmarks.
+ */
+template <typename Filter, typename Key>
+auto filled(const benchmark::State& state) -> const Filter& {
+    static std::mutex mutex;
+    static std::map<std::tuple<std::int64_t, std::int64_t>, std::unique_ptr<Filter>> cache;
+
+    const auto lock = std::scoped_lock{mutex};
+    auto& filter = cache[{state.range(0), state.range(1)}];
+    if (!filter) {
+        const auto elems = static_cast<std::uint64_t>(state.range(0));
+        filter = std::make_unique<Filter>(elems, 1.0 / static_cast<double>(state.range(1)));
+        const auto& pool = inserted<Key>();
+        for (std::uint64_t idx = 0; idx < elems; idx++) {
+            filter->insert(pool[idx % pool.size()]);
+        }
+    }
+    return *filter;
+}
+
+void report(benchmark::State& state, const std::size_t per_iteration, const std::size_t bits) {
+    const auto ops = static_cast<double>(state.iterations() * per_iteration);
+    state.SetItemsProcessed(static_cast<std::int64_t>(ops));
+    state.counters["time/op"] =
+        benchmark::Counter(ops, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    state.counters["bytes"] = static_cast<double>(bits / 8);
+}
+
+template <typename Filter, typename Key>
+void insert(benchmark::State& state) {
+    static std::unique_ptr<Filter> filter;
+    if (state.thread_index() == 0) {
+        filter = std::make_unique<Filter>(static_cast<std::uint64_t>(state.range(0)),
+                                          1.0 / static_cast<double>(state.range(1)));
+    }
+    const auto& pool = inserted<Key>();
+    auto idx = static_cast<std::size_t>(state.thread_index()) * (pool.size() / 64);
+    for (auto _ : state) {
+        filter->insert(pool[idx++ % pool.size()]);
+    }
+    report(state, 1, filter->bits);
+}
+
+template <typename Filter, typename Key>
+void search(benchmark::State& state) {
+    const auto& filter = filled<Filter, Key>(state);
+    const auto& pool = searched<Key>();
+    auto idx = static_cast<std::size_t>(state.thread_index()) * (pool.size() / 64);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(filter.search(pool[idx++ % pool.size()]));
+    }
+    report(state, 1, filter.bits);
+}
+
+template <typename Filter, typename Key>
+void insert_many(benchmark::State& state) {
+    auto filter = Filter{static_cast<std::uint64_t>(state.range(0)),
+                         1.0 / static_cast<double>(state.range(1))};
+    const auto& pool = inserted<Key>();
+    std::size_t off = 0;
+    for (auto _ : state) {
+        filter.insert_many(std::span{pool}.subspan(off, batch));
+        off = (off + batch) % pool.size();
+    }
+    report(state, batch, filter.bits);
+}
+
+template <typename Filter, typename Key>
+void search_many(benchmark::State& state) {
+    const auto& filter = filled<Filter, Key>(state);
+    const auto& pool = searched<Key>();
+    auto res = std::vector<std::uint8_t>(batch);
+    std::size_t off = 0;
+    for (auto _ : state) {
+        filter.search_many(std::span{pool}.subspan(off, batch), res);
+        benchmark::DoNotOptimize(res.data());
+        off = (off + batch) % pool.size();
+    }
+    report(state, batch, filter.bits);
+}
+
+/**
+ * @brief Sweeps the number of elements, from filters which fit into L1 up to filters of several
+ * gigabytes, and the false positive probability, given as its inverse.
+ */
+void sizes(benchmark::internal::Benchmark* bench) {
+    bench->ArgNames({"elems", "inv_eps"});
+    for (const auto eps : {100, 10'000}) {
+        for (std::int64_t elems = 1 << 10; elems <= std::int64_t{1} << 30; elems <<= 4) {
+            bench->Args({elems, eps});
+        }
+    }
+}
+
+void threads(benchmark::internal::Benchmark* bench) {
+    sizes(bench);
+    bench->ThreadRange(1, static_cast<int>(std::max(1U, std::thread::hardware_concurrency())));
+    bench->UseRealTime();
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(insert, bf::BloomFilter<>, int)->Apply(sizes);
+BENCHMARK_TEMPLATE(insert, bf::BloomFilter<>, Short)->Apply(sizes);
+BENCHMARK_TEMPLATE(insert, bf::BloomFilter<>, Long)->Apply(sizes);
+BENCHMARK_TEMPLATE(insert, bf::BlockedBloomFilter<>, int)->Apply(sizes);
+BENCHMARK_TEMPLATE(insert, bf::ConcurrentBloomFilter<>, int)->Apply(threads);
+
+BENCHMARK_TEMPLATE(search, bf::BloomFilter<>, int)->Apply(threads);
+BENCHMARK_TEMPLATE(search, bf::BloomFilter<>, Short)->Apply(sizes);
+BENCHMARK_TEMPLATE(search, bf::BloomFilter<>, Long)->Apply(sizes);
+BENCHMARK_TEMPLATE(search, bf::BlockedBloomFilter<>, int)->Apply(threads);
+
+BENCHMARK_TEMPLATE(insert_many, bf::BloomFilter<>, int)->Apply(sizes);
+BENCHMARK_TEMPLATE(insert_many, bf::BloomFilter<>, Short)->Apply(sizes);
+BENCHMARK_TEMPLATE(insert_many, bf::BlockedBloomFilter<>, int)->Apply(sizes);
+
+BENCHMARK_TEMPLATE(search_many, bf::BloomFilter<>, int)->Apply(sizes);
+BENCHMARK_TEMPLATE(search_many, bf::BloomFilter<>, Short)->Apply(sizes);
+BENCHMARK_TEMPLATE(search_many, bf::BloomFilter<>, Long)->Apply(sizes);
+BENCHMARK_TEMPLATE(search_many, bf::BlockedBloomFilter<>, int)->Apply(sizes);
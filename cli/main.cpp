@@ -0,0 +1,391 @@
+/**
+ * @brief A command-line tool which builds bloom filters from streams of keys and queries them.
+ *
+ * `bf build` reads keys from files, or from the standard input, in large chunks. The keys of a
+ * chunk are hashed and inserted by a thread pool while the next chunk is read, and the filter is
+ * written in the format of `BloomFilter::save`. When the number of keys is not given, regular files
+ * are read twice, first to count the keys and size the filter from the count. Other inputs, such
+ * as pipes, cannot be read again, and their hashes are kept until the end of the input, eight bytes
+ * per key, and inserted in parallel once the filter is sized.
+ *
+ * `bf query` memory-maps a filter and searches the keys of every chunk with the batched SIMD path,
+ * printing one result per key, the keys which were found, or the number of keys which were found.
+ *
+ * Keys are delimited by newlines, or with `--length` by a 4-byte little-endian length.
+ *
+ * Usage:
+ *   bf build -o FILTER [--elems N] [--eps E] [--length] [--threads T] [FILE...]
+ *   bf query FILTER [--matches | --count] [--length] [--threads T] [FILE...]
+ */
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "../include/bf.hpp"
+
+namespace {
+
+// Number of bytes which are read at a time.
+constexpr std::size_t chunk_bytes = std::size_t{16} << 20;
+
+/// @brief Keys of a chunk of the input, which view the bytes of the chunk.
+struct Chunk {
+    std::vector<char> bytes;
+    std::vector<std::string_view> keys;
+};
+
+/**
+ * @brief Splits a sequence of input files into chunks of whole keys. The bytes of a key which is
+ * cut off by the end of a read are carried over into the next chunk.
+ */
+class Reader {
+   public:
+    Reader(std::vector<std::string> paths, const bool length)
+        : paths_{std::move(paths)}, length_{length} {
+        if (paths_.empty()) {
+            paths_.emplace_back("-");
+        }
+    }
+
+    Reader(const Reader&) = delete;
+    auto operator=(const Reader&) -> Reader& = delete;
+
+    ~Reader() {
+        close();
+    }
+
+    /**
+     * @brief Reads the next chunk.
+     * @param chunk Chunk, whose bytes and keys are replaced.
+     * @return Whether a chunk was read, false at the end of the input.
+     */
+    auto next(Chunk& chunk) -> bool {
+        chunk.keys.clear();
+        chunk.bytes.assign(carry_.begin(), carry_.end());
+        carry_.clear();
+        // A key which is longer than a chunk grows the chunk until the key fits.
+        const auto target = std::max(chunk_bytes, 2 * chunk.bytes.size());
+        while (chunk.bytes.size() < target) {
+            if (fd_ < 0 && !open()) {
+                break;
+            }
+            const auto size = chunk.bytes.size();
+            chunk.bytes.resize(target);
+            const auto res = ::read(fd_, chunk.bytes.data() + size, target - size);
+            if (res < 0) {
+                throw std::system_error(errno, std::generic_category(), "read");
+            }
+            chunk.bytes.resize(size + static_cast<std::size_t>(res));
+            if (res == 0) {
+                // A file which does not end with a delimiter ends with its last key.
+                if (!length_ && !chunk.bytes.empty() && chunk.bytes.back() != '\n') {
+                    chunk.bytes.push_back('\n');
+                }
+                close();
+            }
+        }
+        split(chunk);
+        // A chunk may have no keys, when a key is still growing it, before the end of the input.
+        return !chunk.keys.empty() || !done();
+    }
+
+   private:
+    auto open() -> bool {
+        if (next_ == paths_.size()) {
+            return false;
+        }
+        const auto& path = paths_[next_++];
+        fd_ = path == "-" ? STDIN_FILENO : ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0) {
+            throw std::system_error(errno, std::generic_category(), path);
+        }
+#if defined(POSIX_FADV_SEQUENTIAL)
+        ::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+        return true;
+    }
+
+    /// @brief Whether all of the files have been read to their end.
+    [[nodiscard]] auto done() const noexcept -> bool {
+        return fd_ < 0 && next_ == paths_.size();
+    }
+
+    void close() noexcept {
+        if (fd_ > STDIN_FILENO) {
+            ::close(fd_);
+        }
+        fd_ = -1;
+    }
+
+    /// @brief Splits the bytes of a chunk into keys and carries the incomplete key over.
+    void split(Chunk& chunk) {
+        const auto* const begin = chunk.bytes.data();
+        const auto* const end = begin + chunk.bytes.size();
+        const auto* pos = begin;
+        if (length_) {
+            while (end - pos >= 4) {
+                std::uint32_t len = 0;
+                std::memcpy(&len, pos, sizeof(len));
+                if (static_cast<std::size_t>(end - pos - 4) < len) {
+                    break;
+                }
+                chunk.keys.emplace_back(pos + 4, len);
+                pos += 4 + len;
+            }
+        } else {
+            while (pos != end) {
+                const auto* const line = static_cast<const char*>(
+                    std::memchr(pos, '\n', static_cast<std::size_t>(end - pos)));
+                if (line == nullptr) {
+                    break;
+                }
+                // An empty line is an empty key, so that there is one key per line.
+                chunk.keys.emplace_back(pos, static_cast<std::size_t>(line - pos));
+                pos = line + 1;
+            }
+        }
+        carry_.assign(pos, end);
+        if (done() && !carry_.empty()) {
+            throw std::runtime_error("Input ends with an incomplete key.");
+        }
+    }
+
+    std::vector<std::string> paths_;
+    bool length_;
+    std::size_t next_{};
+    int fd_{-1};
+    std::vector<char> carry_;
+};
+
+/**
+ * @brief Runs `fn` on every chunk of the input, reading the next chunk while the previous one is
+ * being processed.
+ * @param reader Reader of the input.
+ * @param fn Function which is called with every chunk.
+ */
+void for_each_chunk(Reader& reader, auto&& fn) {
+    std::array<Chunk, 2> chunks;
+    std::size_t current = 0;
+    if (!reader.next(chunks[current])) {
+        return;
+    }
+    while (true) {
+        std::exception_ptr error;
+        auto worker = std::thread([&] {
+            try {
+                fn(chunks[current]);
+            } catch (...) {
+                error = std::current_exception();
+            }
+        });
+        auto more = false;
+        try {
+            more = reader.next(chunks[current ^ 1]);
+        } catch (...) {
+            worker.join();
+            throw;
+        }
+        worker.join();
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        if (!more) {
+            return;
+        }
+        current ^= 1;
+    }
+}
+
+struct Options {
+    std::vector<std::string> paths;
+    std::string filter;
+    std::optional<std::uint64_t> elems;
+    double eps = 1e-2;
+    bool length = false;
+    bool matches = false;
+    bool count = false;
+    std::size_t threads = std::thread::hardware_concurrency();
+};
+
+/// @brief Whether all of the inputs are regular files, which can be read more than once.
+auto rereadable(const std::vector<std::string>& paths) -> bool {
+    return !paths.empty() && std::ranges::all_of(paths, [](const std::string& path) {
+        struct stat info {};
+        return path != "-" && ::stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode);
+    });
+}
+
+/// @brief Counts the keys of the input.
+auto count_keys(const Options& options) -> std::uint64_t {
+    auto reader = Reader{options.paths, options.length};
+    std::uint64_t keys = 0;
+    for_each_chunk(reader, [&](const Chunk& chunk) { keys += chunk.keys.size(); });
+    return keys;
+}
+
+auto build(const Options& options) -> int {
+    auto pool = bf::ThreadPool{options.threads};
+    std::optional<bf::BloomFilter<>> filter;
+    std::vector<std::uint64_t> hashes;
+    if (options.elems) {
+        filter.emplace(*options.elems, options.eps);
+    } else if (rereadable(options.paths)) {
+        filter.emplace(std::max<std::uint64_t>(count_keys(options), 1), options.eps);
+    }
+
+    auto reader = Reader{options.paths, options.length};
+    std::uint64_t keys = 0;
+    for_each_chunk(reader, [&](const Chunk& chunk) {
+        keys += chunk.keys.size();
+        if (filter) {
+            filter->insert_many(pool, chunk.keys);
+            return;
+        }
+        const auto offset = hashes.size();
+        hashes.resize(offset + chunk.keys.size());
+        pool.parallel_for(chunk.keys.size(), [&](const std::size_t lo, const std::size_t hi) {
+            for (auto idx = lo; idx < hi; idx++) {
+                hashes[offset + idx] = bf::DefaultHasher{}(chunk.keys[idx]);
+            }
+        });
+    });
+
+    if (!filter) {
+        filter.emplace(std::max<std::uint64_t>(keys, 1), options.eps);
+        filter->insert_hashes(pool, hashes);
+    }
+
+    auto out = std::ofstream{options.filter, std::ios::binary};
+    filter->save(out);
+    out.close();
+    if (!out) {
+        throw std::runtime_error("Could not write " + options.filter + ".");
+    }
+    std::cerr << "bf: " << keys << " keys, " << filter->bits << " bits, " << filter->hash_fns
+              << " hash functions\n";
+    return EXIT_SUCCESS;
+}
+
+auto query(const Options& options) -> int {
+    auto pool = bf::ThreadPool{options.threads};
+    auto reader = Reader{options.paths, options.length};
+    const auto filter = bf::MappedBloomFilter<>{options.filter};
+
+    std::vector<std::uint8_t> found;
+    std::vector<char> out;
+    std::uint64_t keys = 0;
+    std::uint64_t positives = 0;
+    for_each_chunk(reader, [&](const Chunk& chunk) {
+        found.resize(chunk.keys.size());
+        pool.parallel_for(chunk.keys.size(), [&](const std::size_t lo, const std::size_t hi) {
+            filter.search_many(std::span{chunk.keys}.subspan(lo, hi - lo),
+                               std::span{found}.subspan(lo, hi - lo));
+        });
+
+        keys += chunk.keys.size();
+        out.clear();
+        for (std::size_t idx = 0; idx < chunk.keys.size(); idx++) {
+            positives += found[idx];
+            if (options.matches) {
+                if (found[idx] != 0) {
+                    out.insert(out.end(), chunk.keys[idx].begin(), chunk.keys[idx].end());
+                    out.push_back('\n');
+                }
+            } else if (!options.count) {
+                out.push_back(found[idx] != 0 ? '1' : '0');
+                out.push_back('\n');
+            }
+        }
+        if (std::fwrite(out.data(), 1, out.size(), stdout) != out.size()) {
+            throw std::system_error(errno, std::generic_category(), "write");
+        }
+    });
+
+    if (options.count) {
+        std::cout << positives << ' ' << keys << '\n';
+    }
+    return EXIT_SUCCESS;
+}
+
+[[noreturn]] void usage() {
+    std::cerr << "Usage:\n"
+                 "  bf build -o FILTER [--elems N] [--eps E] [--length] [--threads T] [FILE...]\n"
+                 "  bf query FILTER [--matches | --count] [--length] [--threads T] [FILE...]\n";
+    std::exit(EXIT_FAILURE);
+}
+
+auto parse(const int argc, char** argv, const bool build) -> Options {
+    auto options = Options{};
+    for (int idx = 2; idx < argc; idx++) {
+        const auto arg = std::string_view{argv[idx]};
+        const auto value = [&] {
+            if (idx + 1 == argc) {
+                usage();
+            }
+            return std::string{argv[++idx]};
+        };
+        if (build && (arg == "-o" || arg == "--output")) {
+            options.filter = value();
+        } else if (build && arg == "--elems") {
+            options.elems = std::stoull(value());
+        } else if (build && arg == "--eps") {
+            options.eps = std::stod(value());
+        } else if (!build && arg == "--matches") {
+            options.matches = true;
+        } else if (!build && arg == "--count") {
+            options.count = true;
+        } else if (arg == "--length") {
+            options.length = true;
+        } else if (arg == "--threads") {
+            options.threads = std::stoull(value());
+        } else if (!build && options.filter.empty()) {
+            options.filter = arg;
+        } else if (arg == "-" || !arg.starts_with('-')) {
+            options.paths.emplace_back(arg);
+        } else {
+            usage();
+        }
+    }
+    if (options.filter.empty() || (options.matches && options.count)) {
+        usage();
+    }
+    options.threads = std::max<std::size_t>(options.threads, 1);
+    return options;
+}
+
+}  // namespace
+
+auto main(int argc, char** argv) -> int {
+    if (argc < 2) {
+        usage();
+    }
+    const auto command = std::string_view{argv[1]};
+    if (command != "build" && command != "query") {
+        usage();
+    }
+    try {
+        const auto options = parse(argc, argv, command == "build");
+        return command == "build" ? build(options) : query(options);
+    } catch (const std::exception& err) {
+        std::cerr << "bf: " << err.what() << '\n';
+        return EXIT_FAILURE;
+    }
+}
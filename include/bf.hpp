@@ -25,97 +25,5121 @@
 #ifndef BF_H
 #define BF_H
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cerrno>
 #include <cmath>
 #include <concepts>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <istream>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <ostream>
 #include <ranges>
+#include <span>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BF_HAS_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BF_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#define BF_HAS_NUMA 1
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 namespace bf {
 
-/// @brief Declaration of the concept `Hashable`, which is satisfied by any type `T` such that for
-/// values `a` of type `T`, the expression `std::hash<T>{}(a)` compiles and its result is
-/// convertible to `std::size_t`. From https://en.cppreference.com/w/cpp/language/constraints.
-template <typename T>
-concept hashable = requires(T a) {
-    { std::hash<T>{}(a) } -> std::convertible_to<std::size_t>;
-};
+/// @brief Declaration of the concept `Hashable`, which is satisfied by any type `T` such that for
+/// values `a` of type `T`, the expression `std::hash<T>{}(a)` compiles and its result is
+/// convertible to `std::size_t`. From https://en.cppreference.com/w/cpp/language/constraints.
+template <typename T>
+concept hashable = requires(T a) {
+    { std::hash<T>{}(a) } -> std::convertible_to<std::size_t>;
+};
+
+template <typename T>
+concept iterable = std::ranges::forward_range<T>;
+
+template <typename T>
+concept arithmetic = std::is_floating_point_v<T>;
+
+using bitvec = std::vector<bool>;
+
+namespace detail {
+
+/// @brief The 64-bit finalizer of MurmurHash3. Every input bit affects every output bit, which
+/// makes it suitable for deriving further probe positions from a single hash value.
+[[nodiscard]] constexpr auto mix64(std::uint64_t x) noexcept -> std::uint64_t {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+/**
+ * @brief Computes the full 128-bit product of two 64-bit integers.
+ * @return The low and the high halves of the product.
+ */
+[[nodiscard]] constexpr auto mul128(const std::uint64_t a, const std::uint64_t b) noexcept
+    -> std::pair<std::uint64_t, std::uint64_t> {
+#if defined(__SIZEOF_INT128__)
+    __extension__ using uint128 = unsigned __int128;
+    const auto res = static_cast<uint128>(a) * b;
+    return {static_cast<std::uint64_t>(res), static_cast<std::uint64_t>(res >> 64)};
+#else
+    const auto lo_lo = (a & 0xffffffff) * (b & 0xffffffff);
+    const auto hi_lo = (a >> 32) * (b & 0xffffffff);
+    const auto lo_hi = (a & 0xffffffff) * (b >> 32);
+    const auto hi_hi = (a >> 32) * (b >> 32);
+    const auto cross = (lo_lo >> 32) + (hi_lo & 0xffffffff) + lo_hi;
+    return {(cross << 32) | (lo_lo & 0xffffffff), (hi_lo >> 32) + (cross >> 32) + hi_hi};
+#endif
+}
+
+/// @brief Multiplies two 64-bit integers and folds the 128-bit product into 64 bits.
+[[nodiscard]] constexpr auto wymix(const std::uint64_t a, const std::uint64_t b) noexcept
+    -> std::uint64_t {
+    const auto [lo, hi] = mul128(a, b);
+    return lo ^ hi;
+}
+
+/// @brief Hashes a 64-bit integer with two rounds of `wymix`, as does `wyhash64` of wyhash.
+[[nodiscard]] constexpr auto wyhash64(const std::uint64_t x) noexcept -> std::uint64_t {
+    constexpr std::uint64_t s0 = 0x2d358dccaa6c78a5ULL;
+    constexpr std::uint64_t s1 = 0x8bb84b93962eacc9ULL;
+    const auto [lo, hi] = mul128(x ^ s0, s1);
+    return wymix(lo ^ s0, hi ^ s1);
+}
+
+/// @brief Reads `N` bytes as a little-endian integer.
+template <std::size_t N, typename Byte>
+[[nodiscard]] constexpr auto read(const Byte* ptr) noexcept -> std::uint64_t {
+    static_assert(sizeof(Byte) == 1 && N <= sizeof(std::uint64_t));
+    if (!std::is_constant_evaluated() && std::endian::native == std::endian::little) {
+        if constexpr (N == 1) {
+            return static_cast<std::uint8_t>(ptr[0]);
+        } else if constexpr (N == 4) {
+            std::uint32_t res = 0;
+            std::memcpy(&res, ptr, N);
+            return res;
+        } else {
+            std::uint64_t res = 0;
+            std::memcpy(&res, ptr, N);
+            return res;
+        }
+    }
+    std::uint64_t res = 0;
+    for (std::size_t idx = 0; idx < N; idx++) {
+        res |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(ptr[idx])) << (8 * idx);
+    }
+    return res;
+}
+
+/**
+ * @brief Hashes a sequence of bytes. This is the final version of wyhash by Wang Yi, which
+ * processes 48 bytes per iteration and needs only a couple of multiplications for short keys.
+ * @param ptr Pointer to the bytes to be hashed.
+ * @param len Number of bytes to be hashed.
+ * @param seed Seed of the hash function.
+ * @return The hash of the bytes.
+ */
+template <typename Byte>
+[[nodiscard]] constexpr auto wyhash(const Byte* ptr, const std::size_t len,
+                                    std::uint64_t seed) noexcept -> std::uint64_t {
+    constexpr std::array<std::uint64_t, 4> secret = {0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL,
+                                                     0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL};
+
+    seed ^= wymix(seed ^ secret[0], secret[1]);
+    std::uint64_t a = 0;
+    std::uint64_t b = 0;
+    if (len <= 16) {
+        if (len >= 4) {
+            const auto off = (len >> 3) << 2;
+            a = (read<4>(ptr) << 32) | read<4>(ptr + off);
+            b = (read<4>(ptr + len - 4) << 32) | read<4>(ptr + len - 4 - off);
+        } else if (len > 0) {
+            a = (read<1>(ptr) << 16) | (read<1>(ptr + (len >> 1)) << 8) | read<1>(ptr + len - 1);
+        }
+    } else {
+        auto rem = len;
+        if (rem >= 48) {
+            auto see1 = seed;
+            auto see2 = seed;
+            do {
+                seed = wymix(read<8>(ptr) ^ secret[1], read<8>(ptr + 8) ^ seed);
+                see1 = wymix(read<8>(ptr + 16) ^ secret[2], read<8>(ptr + 24) ^ see1);
+                see2 = wymix(read<8>(ptr + 32) ^ secret[3], read<8>(ptr + 40) ^ see2);
+                ptr += 48;
+                rem -= 48;
+            } while (rem >= 48);
+            seed ^= see1 ^ see2;
+        }
+        while (rem > 16) {
+            seed = wymix(read<8>(ptr) ^ secret[1], read<8>(ptr + 8) ^ seed);
+            ptr += 16;
+            rem -= 16;
+        }
+        a = read<8>(ptr + rem - 16);
+        b = read<8>(ptr + rem - 8);
+    }
+    const auto [lo, hi] = mul128(a ^ secret[1], b ^ seed);
+    return wymix(lo ^ secret[0] ^ len, hi ^ secret[1]);
+}
+
+/**
+ * @brief Hashes a sequence of bytes with XXH64 by Yann Collet, which is the hash function of the
+ * bloom filters of Apache Parquet.
+ * @param ptr Pointer to the bytes to be hashed.
+ * @param len Number of bytes to be hashed.
+ * @param seed Seed of the hash function.
+ * @return The hash of the bytes.
+ */
+template <typename Byte>
+[[nodiscard]] constexpr auto xxh64(const Byte* ptr, const std::size_t len,
+                                   const std::uint64_t seed) noexcept -> std::uint64_t {
+    constexpr std::uint64_t p1 = 0x9e3779b185ebca87ULL;
+    constexpr std::uint64_t p2 = 0xc2b2ae3d27d4eb4fULL;
+    constexpr std::uint64_t p3 = 0x165667b19e3779f9ULL;
+    constexpr std::uint64_t p4 = 0x85ebca77c2b2ae63ULL;
+    constexpr std::uint64_t p5 = 0x27d4eb2f165667c5ULL;
+
+    const auto round = [](std::uint64_t acc, const std::uint64_t input) {
+        acc += input * p2;
+        return std::rotl(acc, 31) * p1;
+    };
+    const auto merge = [&](const std::uint64_t acc, const std::uint64_t val) {
+        return (acc ^ round(0, val)) * p1 + p4;
+    };
+
+    const auto* const end = ptr + len;
+    std::uint64_t res = 0;
+    if (len >= 32) {
+        auto v1 = seed + p1 + p2;
+        auto v2 = seed + p2;
+        auto v3 = seed;
+        auto v4 = seed - p1;
+        for (; end - ptr >= 32; ptr += 32) {
+            v1 = round(v1, read<8>(ptr));
+            v2 = round(v2, read<8>(ptr + 8));
+            v3 = round(v3, read<8>(ptr + 16));
+            v4 = round(v4, read<8>(ptr + 24));
+        }
+        res = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) + std::rotl(v4, 18);
+        res = merge(merge(merge(merge(res, v1), v2), v3), v4);
+    } else {
+        res = seed + p5;
+    }
+
+    res += len;
+    for (; end - ptr >= 8; ptr += 8) {
+        res = std::rotl(res ^ round(0, read<8>(ptr)), 27) * p1 + p4;
+    }
+    if (end - ptr >= 4) {
+        res = std::rotl(res ^ (read<4>(ptr) * p1), 23) * p2 + p3;
+        ptr += 4;
+    }
+    for (; ptr != end; ptr++) {
+        res = std::rotl(res ^ (read<1>(ptr) * p5), 11) * p1;
+    }
+
+    res ^= res >> 33;
+    res *= p2;
+    res ^= res >> 29;
+    res *= p3;
+    res ^= res >> 32;
+    return res;
+}
+
+/**
+ * @brief Probe positions of an element. Following Kirsch and Mitzenmacher, the `idx`-th position
+ * is derived from two hash values as `h1 + idx * h2`, so that the element is hashed only once and
+ * the false positive probability matches that of `k` independent hash functions asymptotically.
+ */
+struct Probes {
+    std::uint64_t h1{};
+    std::uint64_t h2{};
+
+    constexpr Probes() noexcept = default;
+
+    /**
+     * @brief Derives both of the hash values from a single, well-distributed hash of an element.
+     * @param hash Hash of an element.
+     */
+    explicit constexpr Probes(const std::uint64_t hash) noexcept
+        : h1{hash}, h2{mix64(hash ^ 0x9e3779b97f4a7c15ULL) | 1} {}
+
+    [[nodiscard]] constexpr auto operator[](const std::uint64_t idx) const noexcept {
+        return h1 + idx * h2;
+    }
+};
+
+// Size in bytes from which words are zeroed with non-temporal stores, which bypass the cache
+// instead of evicting all of it for storage that is not about to be read.
+inline constexpr std::size_t stream_bytes = std::size_t{4} << 20;
+
+/**
+ * @brief Zeroes words in place. Whole, aligned cache lines are zeroed with non-temporal stores when
+ * `stream` is set and the target supports them.
+ * @param words Words to be zeroed.
+ * @param n Number of words.
+ * @param stream Whether to bypass the cache.
+ */
+inline void zero_words(std::uint64_t* words, const std::size_t n, const bool stream) noexcept {
+#if defined(BF_HAS_X86_SIMD)
+    if (stream && reinterpret_cast<std::uintptr_t>(words) % 64 == 0 && n % 8 == 0) {
+        auto* ptr = reinterpret_cast<__m128i*>(words);
+        for (std::size_t idx = 0; idx < n / 2; idx++) {
+            _mm_stream_si128(ptr + idx, _mm_setzero_si128());
+        }
+        _mm_sfence();
+        return;
+    }
+#endif
+    std::memset(words, 0, n * sizeof(std::uint64_t));
+}
+
+/// @brief A block of `Align` bytes aligned to `Align` bytes, the unit of aligned allocations.
+template <std::size_t Align>
+struct alignas(Align) AlignedBlock {
+    std::byte bytes[Align];
+};
+
+}  // namespace detail
+
+/**
+ * @brief An allocator that aligns every allocation to `Align` bytes. The memory is allocated from
+ * `Upstream` rebound to blocks of `Align` bytes, so that any allocator, including
+ * `std::pmr::polymorphic_allocator` over an arena, can back cache-line-aligned storage.
+ */
+template <typename T, std::size_t Align = 64, typename Upstream = std::allocator<std::byte>>
+struct AlignedAllocator {
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Align, Upstream>;
+    };
+
+    constexpr AlignedAllocator() noexcept = default;
+
+    /**
+     * @brief Creates an allocator which allocates from an upstream allocator.
+     * @param upstream The upstream allocator, or anything that converts to it, such as a
+     * `std::pmr::memory_resource*` for `std::pmr::polymorphic_allocator`.
+     */
+    template <typename Arg>
+        requires std::convertible_to<Arg, Upstream>
+    // NOLINTNEXTLINE(google-explicit-constructor): allocators are passed as their resources.
+    constexpr AlignedAllocator(Arg&& upstream) noexcept : upstream_(std::forward<Arg>(upstream)) {}
+
+    template <typename U>
+    // NOLINTNEXTLINE(google-explicit-constructor): allocators convert implicitly on rebinding.
+    constexpr AlignedAllocator(const AlignedAllocator<U, Align, Upstream>& other) noexcept
+        : upstream_(other.upstream()) {}
+
+    [[nodiscard]] auto allocate(const std::size_t n) -> T* {
+        auto alloc = block_allocator(upstream_);
+        return reinterpret_cast<T*>(block_traits::allocate(alloc, blocks(n)));
+    }
+
+    void deallocate(T* ptr, const std::size_t n) noexcept {
+        auto alloc = block_allocator(upstream_);
+        block_traits::deallocate(alloc, reinterpret_cast<detail::AlignedBlock<Align>*>(ptr),
+                                 blocks(n));
+    }
+
+    /// @brief The upstream allocator.
+    [[nodiscard]] constexpr auto upstream() const noexcept -> const Upstream& {
+        return upstream_;
+    }
+
+    template <typename U>
+    [[nodiscard]] constexpr auto operator==(
+        const AlignedAllocator<U, Align, Upstream>& other) const noexcept {
+        return upstream_ == other.upstream();
+    }
+
+   private:
+    using block_allocator = typename std::allocator_traits<Upstream>::template rebind_alloc<
+        detail::AlignedBlock<Align>>;
+    using block_traits = std::allocator_traits<block_allocator>;
+
+    [[nodiscard]] static constexpr auto blocks(const std::size_t n) noexcept -> std::size_t {
+        return (n * sizeof(T) + Align - 1) / Align;
+    }
+
+    [[no_unique_address]] Upstream upstream_{};
+};
+
+#if defined(BF_HAS_MMAP)
+/**
+ * @brief An allocator that backs every allocation with huge pages of `PageSize` bytes, which cuts
+ * the TLB misses of large filters. The pages are reserved with `MAP_HUGETLB` when the system has
+ * a pool of huge pages, and requested from transparent huge pages with `madvise` otherwise. Every
+ * allocation is rounded up to whole pages, so that it only suits large, long-lived storage.
+ */
+template <typename T, std::size_t PageSize = std::size_t{2} << 20>
+struct HugePageAllocator {
+    static_assert(std::has_single_bit(PageSize), "Page size must be a power of two.");
+
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = HugePageAllocator<U, PageSize>;
+    };
+
+    constexpr HugePageAllocator() noexcept = default;
+
+    template <typename U>
+    // NOLINTNEXTLINE(google-explicit-constructor): allocators convert implicitly on rebinding.
+    constexpr HugePageAllocator(const HugePageAllocator<U, PageSize>& /*other*/) noexcept {}
+
+    [[nodiscard]] auto allocate(const std::size_t n) -> T* {
+        const auto len = length(n);
+        void* ptr = MAP_FAILED;
+#if defined(MAP_HUGETLB)
+        auto flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#if defined(MAP_HUGE_SHIFT)
+        flags |= std::countr_zero(PageSize) << MAP_HUGE_SHIFT;
+#endif
+        ptr = ::mmap(nullptr, len, PROT_READ | PROT_WRITE, flags, -1, 0);
+#endif
+        if (ptr == MAP_FAILED) {
+            ptr = ::mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (ptr == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+#if defined(MADV_HUGEPAGE)
+            // Transparent huge pages are a hint; the memory is usable without them.
+            ::madvise(ptr, len, MADV_HUGEPAGE);
+#endif
+        }
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, const std::size_t n) noexcept {
+        ::munmap(ptr, length(n));
+    }
+
+    template <typename U>
+    [[nodiscard]] constexpr auto operator==(
+        const HugePageAllocator<U, PageSize>& /*other*/) const noexcept {
+        return true;
+    }
+
+   private:
+    [[nodiscard]] static constexpr auto length(const std::size_t n) noexcept -> std::size_t {
+        return (n * sizeof(T) + PageSize - 1) / PageSize * PageSize;
+    }
+};
+#endif
+
+/**
+ * @brief A fixed-size array of bits stored in 64-bit words. The storage is aligned to and padded
+ * to whole cache lines, so that the words can be loaded and stored with vector instructions,
+ * copied, popcounted, and written out as is. The storage is allocated with `Allocator`, which is
+ * expected to align it to cache lines, as `AlignedAllocator` does.
+ */
+template <typename Allocator = AlignedAllocator<std::uint64_t>>
+class BasicBitArray {
+   public:
+    using word_type = std::uint64_t;
+    using allocator_type = Allocator;
+
+    // Number of bits in a word.
+    static constexpr std::size_t word_bits = 64;
+    // Alignment of the storage in bytes.
+    static constexpr std::size_t alignment = 64;
+    // Number of words in a cache line.
+    static constexpr std::size_t line_words = alignment / sizeof(word_type);
+
+    BasicBitArray() = default;
+
+    /**
+     * @brief Creates a new bit array with all of the bits cleared.
+     * @param bits Number of bits in the array.
+     * @param alloc Allocator of the storage.
+     */
+    explicit BasicBitArray(const std::size_t bits, const Allocator& alloc = {})
+        : bits_{bits}, words_(words_for(bits), 0, alloc) {}
+
+    /**
+     * @brief Computes the number of words in the storage of a bit array.
+     * @param bits Number of bits in the array.
+     * @return The number of words, including the padding of the last cache line.
+     */
+    [[nodiscard]] static constexpr auto words_for(const std::size_t bits) noexcept -> std::size_t {
+        return (bits + line_bits - 1) / line_bits * line_words;
+    }
+
+    /**
+     * @brief Sets the bit at the provided position.
+     * @param pos Position of the bit.
+     */
+    constexpr void set(const std::size_t pos) noexcept {
+        words_[pos / word_bits] |= word_type{1} << (pos % word_bits);
+    }
+
+    /**
+     * @brief Checks whether the bit at the provided position is set.
+     * @param pos Position of the bit.
+     * @return A boolean value specifying whether the bit was set or not.
+     */
+    [[nodiscard]] constexpr auto test(const std::size_t pos) const noexcept -> bool {
+        return ((words_[pos / word_bits] >> (pos % word_bits)) & 1) != 0;
+    }
+
+    [[nodiscard]] constexpr auto operator[](const std::size_t pos) const noexcept -> bool {
+        return test(pos);
+    }
+
+    /// @brief Number of bits in the array.
+    [[nodiscard]] constexpr auto size() const noexcept -> std::size_t {
+        return bits_;
+    }
+
+    /// @brief Number of words in the storage, including the padding of the last cache line.
+    [[nodiscard]] constexpr auto words() const noexcept -> std::size_t {
+        return words_.size();
+    }
+
+    [[nodiscard]] constexpr auto data() noexcept -> word_type* {
+        return words_.data();
+    }
+
+    [[nodiscard]] constexpr auto data() const noexcept -> const word_type* {
+        return words_.data();
+    }
+
+    [[nodiscard]] constexpr auto get_allocator() const noexcept -> Allocator {
+        return words_.get_allocator();
+    }
+
+    /**
+     * @brief Clears all of the bits in place, without reallocating the storage. Arrays of at least
+     * `detail::stream_bytes` bytes are cleared with non-temporal stores.
+     */
+    void clear() noexcept {
+        detail::zero_words(data(), words(), words() * sizeof(word_type) >= detail::stream_bytes);
+    }
+
+   private:
+    static constexpr std::size_t line_bits = line_words * word_bits;
+
+    std::size_t bits_{};
+    std::vector<word_type, Allocator> words_;
+};
+
+// A bit array on the global heap.
+using BitArray = BasicBitArray<>;
+
+namespace detail {
+
+/// @brief Declaration of the concept `byte_range`, which is satisfied by contiguous ranges of
+/// bytes, such as `std::span<const std::byte>`, whose contents are hashed in place.
+template <typename T>
+concept byte_range = std::ranges::contiguous_range<const T> && std::ranges::sized_range<const T> &&
+                     sizeof(std::ranges::range_value_t<T>) == 1 &&
+                     std::is_trivially_copyable_v<std::ranges::range_value_t<T>>;
+
+}  // namespace detail
+
+/**
+ * @brief A fast hasher for sequences of bytes, such as strings and contiguous ranges of trivially
+ * copyable values, based on wyhash.
+ */
+struct WyHash {
+    // Identifier of the hash function in serialized filters.
+    static constexpr std::uint32_t id = 1;
+    // Seed of the hash function.
+    std::uint64_t seed{};
+
+    [[nodiscard]] constexpr auto operator()(const std::string_view data) const noexcept
+        -> std::uint64_t {
+        return detail::wyhash(data.data(), data.size(), seed);
+    }
+
+    template <std::ranges::contiguous_range R>
+        requires std::is_trivially_copyable_v<std::ranges::range_value_t<R>>
+    [[nodiscard]] auto operator()(const R& data) const noexcept -> std::uint64_t {
+        const auto bytes = std::as_bytes(
+            std::span{std::ranges::data(data), std::ranges::size(data)});
+        return detail::wyhash(bytes.data(), bytes.size(), seed);
+    }
+};
+
+/**
+ * @brief A hasher for integers. Unlike `std::hash`, which is the identity for integers in the
+ * common standard libraries, the result depends on all of the bits of the input.
+ */
+struct IntegerMixer {
+    // Identifier of the hash function in serialized filters.
+    static constexpr std::uint32_t id = 2;
+
+    template <typename T>
+        requires std::integral<T> || std::is_enum_v<T>
+    [[nodiscard]] constexpr auto operator()(const T data) const noexcept -> std::uint64_t {
+        if constexpr (std::is_enum_v<T>) {
+            using underlying = std::underlying_type_t<T>;
+            return detail::wyhash64(static_cast<std::uint64_t>(static_cast<underlying>(data)));
+        } else {
+            return detail::wyhash64(static_cast<std::uint64_t>(data));
+        }
+    }
+};
+
+/**
+ * @brief A hasher based on XXH64 which hashes values by their plain encoding in Apache Parquet:
+ * strings by their bytes and numbers by their little-endian bytes, so that the hashes match those
+ * of the bloom filters in Parquet files.
+ */
+struct XXHash64 {
+    // Identifier of the hash function in serialized filters.
+    static constexpr std::uint32_t id = 4;
+    // Seed of the hash function, which is zero in Parquet.
+    std::uint64_t seed{};
+
+    [[nodiscard]] constexpr auto operator()(const std::string_view data) const noexcept
+        -> std::uint64_t {
+        return detail::xxh64(data.data(), data.size(), seed);
+    }
+
+    [[nodiscard]] constexpr auto operator()(const std::span<const std::byte> data) const noexcept
+        -> std::uint64_t {
+        return detail::xxh64(data.data(), data.size(), seed);
+    }
+
+    template <typename T>
+        requires(std::integral<T> || std::floating_point<T>) && (!std::same_as<T, bool>)
+    [[nodiscard]] constexpr auto operator()(const T data) const noexcept -> std::uint64_t {
+        static_assert(std::endian::native == std::endian::little,
+                      "Plain encoding is only supported on little-endian targets.");
+        const auto bytes = std::bit_cast<std::array<unsigned char, sizeof(T)>>(data);
+        return detail::xxh64(bytes.data(), bytes.size(), seed);
+    }
+};
+
+/**
+ * @brief The default hasher, which picks a hash function by the type of the input. Strings are
+ * hashed by their contents with `WyHash`, integers and floating-point numbers with `IntegerMixer`,
+ * and any other type with `std::hash` followed by `IntegerMixer`.
+ */
+struct DefaultHasher {
+    // Identifier of the hash function in serialized filters.
+    static constexpr std::uint32_t id = 3;
+
+    template <typename T>
+        requires std::convertible_to<const T&, std::string_view> || detail::byte_range<T> ||
+                 std::integral<T> || std::is_enum_v<T> || std::floating_point<T> || hashable<T>
+    [[nodiscard]] constexpr auto operator()(const T& data) const noexcept -> std::uint64_t {
+        if constexpr (std::convertible_to<const T&, std::string_view>) {
+            return WyHash{}(std::string_view{data});
+        } else if constexpr (detail::byte_range<T>) {
+            return WyHash{}(data);
+        } else if constexpr (std::integral<T> || std::is_enum_v<T>) {
+            return IntegerMixer{}(data);
+        } else if constexpr (std::is_same_v<T, float>) {
+            return IntegerMixer{}(std::bit_cast<std::uint32_t>(data == 0 ? 0.0F : data));
+        } else if constexpr (std::is_same_v<T, double>) {
+            return IntegerMixer{}(std::bit_cast<std::uint64_t>(data == 0 ? 0.0 : data));
+        } else {
+            return IntegerMixer{}(static_cast<std::uint64_t>(std::hash<T>{}(data)));
+        }
+    }
+};
+
+/**
+ * @brief Maps hash values onto a range with the multiply-shift reduction of Lemire, which costs a
+ * single multiplication instead of the division of `%`. The number of bits is left as is.
+ */
+struct FastRange {
+    // Identifier of the range reduction in serialized filters.
+    static constexpr std::uint32_t id = 1;
+
+    [[nodiscard]] static constexpr auto size(const std::size_t n) noexcept -> std::size_t {
+        return n;
+    }
+
+    [[nodiscard]] static constexpr auto reduce(const std::uint64_t hash,
+                                               const std::size_t n) noexcept -> std::size_t {
+        return detail::mul128(hash, n).second;
+    }
+};
+
+/**
+ * @brief Maps hash values onto a range by masking. The number of bits is rounded up to a power of
+ * two, which trades memory for the cheapest possible reduction.
+ */
+struct PowerOfTwo {
+    // Identifier of the range reduction in serialized filters.
+    static constexpr std::uint32_t id = 2;
+
+    [[nodiscard]] static constexpr auto size(const std::size_t n) noexcept -> std::size_t {
+        return std::bit_ceil(n);
+    }
+
+    [[nodiscard]] static constexpr auto reduce(const std::uint64_t hash,
+                                               const std::size_t n) noexcept -> std::size_t {
+        return hash & (n - 1);
+    }
+};
+
+/// @brief Declaration of the concept `hashable_with`, which is satisfied by any type `T` that the
+/// hasher `Hasher` maps to a 64-bit hash value.
+template <typename T, typename Hasher>
+concept hashable_with = requires(const Hasher& hasher, const T& a) {
+    { hasher(a) } -> std::convertible_to<std::uint64_t>;
+};
+
+/// @brief Declaration of the concept `executor`, which is satisfied by any type `E` that can run
+/// a function over chunks `[begin, end)` of the range `[0, n)` in parallel, returning once all of
+/// the chunks have been processed.
+template <typename E>
+concept executor = requires(E& ex, const std::size_t n,
+                            const std::function<void(std::size_t, std::size_t)>& fn) {
+    ex.parallel_for(n, fn);
+};
+
+/**
+ * @brief A small work-stealing thread pool. A parallel loop is split into chunks which are dealt
+ * out to the queues of the workers; a worker takes chunks from the front of its own queue and,
+ * once that is empty, steals from the back of the queues of the other workers.
+ */
+class ThreadPool {
+   public:
+    /**
+     * @brief Creates a new thread pool.
+     * @param threads Number of worker threads.
+     */
+    explicit ThreadPool(const std::size_t threads = std::thread::hardware_concurrency())
+        : queues_(std::max<std::size_t>(threads, 1)) {
+        for (std::size_t idx = 0; idx < queues_.size(); idx++) {
+            workers_.emplace_back([this, idx] { work(idx); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool(ThreadPool&&) = delete;
+    auto operator=(const ThreadPool&) -> ThreadPool& = delete;
+    auto operator=(ThreadPool&&) -> ThreadPool& = delete;
+
+    ~ThreadPool() {
+        {
+            const auto lock = std::scoped_lock{mutex_};
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    /// @brief Number of worker threads.
+    [[nodiscard]] auto size() const noexcept -> std::size_t {
+        return workers_.size();
+    }
+
+    /**
+     * @brief Runs a function over chunks of the range `[0, n)` on the worker threads and waits
+     * for all of them to finish. The first exception thrown by the function is rethrown.
+     * @param n Size of the range.
+     * @param fn Function which is called with the bounds `[begin, end)` of every chunk.
+     */
+    void parallel_for(const std::size_t n,
+                      const std::function<void(std::size_t, std::size_t)>& fn) {
+        if (n == 0) {
+            return;
+        }
+
+        const auto call = std::scoped_lock{call_mutex_};
+        const auto chunks = std::min(n, queues_.size() * chunks_per_worker);
+        {
+            const auto lock = std::scoped_lock{mutex_};
+            pending_ = chunks;
+            error_ = nullptr;
+        }
+        for (std::size_t idx = 0; idx < chunks; idx++) {
+            auto& queue = queues_[idx % queues_.size()];
+            const auto lock = std::scoped_lock{queue.mutex};
+            queue.chunks.push_back({&fn, n * idx / chunks, n * (idx + 1) / chunks});
+        }
+
+        auto lock = std::unique_lock{mutex_};
+        generation_++;
+        wake_.notify_all();
+        done_.wait(lock, [this] { return pending_ == 0; });
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+    }
+
+   private:
+    // Number of chunks that a parallel loop is split into per worker.
+    static constexpr std::size_t chunks_per_worker = 8;
+
+    struct Chunk {
+        const std::function<void(std::size_t, std::size_t)>* fn;
+        std::size_t begin;
+        std::size_t end;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Chunk> chunks;
+    };
+
+    /// @brief Takes a chunk from the own queue of a worker or steals one from another queue.
+    auto take(const std::size_t idx) -> std::optional<Chunk> {
+        for (std::size_t off = 0; off < queues_.size(); off++) {
+            auto& queue = queues_[(idx + off) % queues_.size()];
+            const auto lock = std::scoped_lock{queue.mutex};
+            if (queue.chunks.empty()) {
+                continue;
+            }
+            if (off == 0) {
+                const auto chunk = queue.chunks.front();
+                queue.chunks.pop_front();
+                return chunk;
+            }
+            const auto chunk = queue.chunks.back();
+            queue.chunks.pop_back();
+            return chunk;
+        }
+        return std::nullopt;
+    }
+
+    void work(const std::size_t idx) {
+        std::size_t seen = 0;
+        while (true) {
+            {
+                auto lock = std::unique_lock{mutex_};
+                wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                if (stop_) {
+                    return;
+                }
+                seen = generation_;
+            }
+
+            while (const auto chunk = take(idx)) {
+                try {
+                    (*chunk->fn)(chunk->begin, chunk->end);
+                } catch (...) {
+                    const auto lock = std::scoped_lock{mutex_};
+                    if (!error_) {
+                        error_ = std::current_exception();
+                    }
+                }
+                const auto lock = std::scoped_lock{mutex_};
+                if (--pending_ == 0) {
+                    done_.notify_all();
+                }
+            }
+        }
+    }
+
+    std::vector<Queue> queues_;
+    std::vector<std::thread> workers_;
+    std::mutex call_mutex_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    std::size_t pending_{};
+    std::size_t generation_{};
+    std::exception_ptr error_;
+    bool stop_{};
+};
+
+template <typename T = void>
+class Task;
+
+namespace detail {
+
+/// @brief Result of a `Task`, which is a value or an exception.
+template <typename T>
+struct TaskResult {
+    std::optional<T> value;
+    std::exception_ptr error;
+
+    void return_value(T res) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        value.emplace(std::move(res));
+    }
+
+    auto result() -> T {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return std::move(*value);
+    }
+};
+
+/**
+ * @brief Per-thread cache of the frames of `Task` coroutines, one free list per multiple of 64
+ * bytes, so that the tasks of a stream of lookups reuse the frames of the finished ones instead of
+ * going through the heap.
+ */
+class FrameCache {
+   public:
+    // Granularity of the size classes in bytes.
+    static constexpr std::size_t granularity = 64;
+    // Number of size classes; larger frames are allocated on the heap.
+    static constexpr std::size_t classes = 16;
+
+    FrameCache() = default;
+    FrameCache(const FrameCache&) = delete;
+    auto operator=(const FrameCache&) -> FrameCache& = delete;
+
+    ~FrameCache() {
+        for (auto* head : heads_) {
+            while (head != nullptr) {
+                ::operator delete(std::exchange(head, head->next));
+            }
+        }
+    }
+
+    [[nodiscard]] static auto allocate(const std::size_t size) -> void* {
+        const auto cls = (size - 1) / granularity;
+        if (cls >= classes) {
+            return ::operator new(size);
+        }
+        auto& head = local().heads_[cls];
+        if (head == nullptr) {
+            return ::operator new((cls + 1) * granularity);
+        }
+        return std::exchange(head, head->next);
+    }
+
+    static void deallocate(void* ptr, const std::size_t size) noexcept {
+        const auto cls = (size - 1) / granularity;
+        if (cls >= classes) {
+            ::operator delete(ptr);
+            return;
+        }
+        auto& head = local().heads_[cls];
+        head = ::new (ptr) Node{head};
+    }
+
+   private:
+    struct Node {
+        Node* next;
+    };
+
+    [[nodiscard]] static auto local() noexcept -> FrameCache& {
+        thread_local FrameCache cache;
+        return cache;
+    }
+
+    std::array<Node*, classes> heads_{};
+};
+
+template <>
+struct TaskResult<void> {
+    std::exception_ptr error;
+
+    void return_void() noexcept {}
+
+    void result() const {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+}  // namespace detail
+
+/**
+ * @brief A lazily started coroutine which produces a value of type `T`. A task runs when it is
+ * awaited, from any kind of coroutine, or when it is spawned on an `Interleaver`, and resumes its
+ * awaiter once it is done.
+ */
+template <typename T>
+class [[nodiscard]] Task {
+   public:
+    struct promise_type : detail::TaskResult<T> {
+        // Coroutine which awaits the task, if any.
+        std::coroutine_handle<> continuation;
+
+        [[nodiscard]] static auto operator new(const std::size_t size) -> void* {
+            return detail::FrameCache::allocate(size);
+        }
+
+        static void operator delete(void* ptr, const std::size_t size) noexcept {
+            detail::FrameCache::deallocate(ptr, size);
+        }
+
+        auto get_return_object() noexcept -> Task {
+            return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        auto initial_suspend() noexcept -> std::suspend_always {
+            return {};
+        }
+
+        auto final_suspend() noexcept {
+            struct Final {
+                [[nodiscard]] auto await_ready() const noexcept -> bool {
+                    return false;
+                }
+
+                [[nodiscard]] auto await_suspend(
+                    const std::coroutine_handle<promise_type> handle) const noexcept
+                    -> std::coroutine_handle<> {
+                    const auto next = handle.promise().continuation;
+                    return next ? next : std::noop_coroutine();
+                }
+
+                void await_resume() const noexcept {}
+            };
+            return Final{};
+        }
+
+        void unhandled_exception() noexcept {
+            this->error = std::current_exception();
+        }
+    };
+
+    Task() noexcept = default;
+
+    Task(Task&& other) noexcept : handle_{std::exchange(other.handle_, {})} {}
+
+    auto operator=(Task&& other) noexcept -> Task& {
+        if (this != &other) {
+            destroy();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+
+    ~Task() {
+        destroy();
+    }
+
+    /// @brief Whether the task has run to completion.
+    [[nodiscard]] auto done() const noexcept -> bool {
+        return handle_ && handle_.done();
+    }
+
+    /**
+     * @brief Result of a task which is done.
+     * @return The value of the task.
+     * @throws The exception which the task exited with, if any.
+     */
+    auto result() -> T {
+        return handle_.promise().result();
+    }
+
+    /// @brief Awaits the task, which runs it and resumes the awaiter with its result.
+    auto operator co_await() && noexcept {
+        struct Awaiter {
+            std::coroutine_handle<promise_type> handle;
+
+            [[nodiscard]] auto await_ready() const noexcept -> bool {
+                return handle.done();
+            }
+
+            [[nodiscard]] auto await_suspend(const std::coroutine_handle<> caller) const noexcept
+                -> std::coroutine_handle<> {
+                handle.promise().continuation = caller;
+                return handle;
+            }
+
+            auto await_resume() const -> T {
+                return handle.promise().result();
+            }
+        };
+        return Awaiter{handle_};
+    }
+
+   private:
+    friend class Interleaver;
+
+    explicit Task(const std::coroutine_handle<promise_type> handle) noexcept : handle_{handle} {}
+
+    void destroy() noexcept {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+/**
+ * @brief A single-threaded scheduler which interleaves coroutines to hide the latency of memory
+ * (Jonathan, Minhas, Hegazy, and Psaropoulos, 2018). A coroutine issues the prefetch of the memory
+ * that it is about to read and suspends itself with `co_await yield()`; the scheduler resumes
+ * coroutines in the order in which they suspended, so that a coroutine is resumed once the others
+ * have run, when its memory has likely arrived. Any coroutine can yield, so that the lookups of
+ * the filters interleave with other work, such as the lookups of hash tables.
+ */
+class Interleaver {
+   public:
+    /**
+     * @brief Awaitable which suspends the awaiting coroutine to the back of the queue.
+     */
+    struct Yield {
+        Interleaver& scheduler;
+
+        [[nodiscard]] auto await_ready() const noexcept -> bool {
+            return false;
+        }
+
+        void await_suspend(const std::coroutine_handle<> handle) const {
+            scheduler.push(handle);
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    Interleaver() = default;
+    Interleaver(const Interleaver&) = delete;
+    auto operator=(const Interleaver&) -> Interleaver& = delete;
+
+    /// @brief Suspends the awaiting coroutine until the coroutines before it have run.
+    [[nodiscard]] auto yield() noexcept -> Yield {
+        return Yield{*this};
+    }
+
+    /**
+     * @brief Queues a task which was not started, which runs until it first yields when the
+     * scheduler gets to it. The task must outlive its run.
+     * @param task Task to be run.
+     */
+    template <typename T>
+    void spawn(Task<T>& task) {
+        push(task.handle_);
+    }
+
+    /**
+     * @brief Resumes the coroutine at the front of the queue.
+     * @return Whether there was a coroutine to resume.
+     */
+    auto step() -> bool {
+        if (head_ == tail_) {
+            return false;
+        }
+        const auto handle = ready_[head_++ & (ready_.size() - 1)];
+        handle.resume();
+        return true;
+    }
+
+    /**
+     * @brief Runs coroutines until all of them are done.
+     */
+    void run() {
+        while (step()) {
+        }
+    }
+
+    /**
+     * @brief Runs a task per index, with up to `group` of them interleaved at a time, along with
+     * the coroutines which were already queued. `fn` is called with an index to create its task,
+     * which is started once an earlier task is done.
+     * @param n Number of tasks.
+     * @param group Number of tasks in flight, such as `prefetch_window`.
+     * @param fn Function which is called with every index and returns a `Task<>`.
+     * @throws The first exception which a task exits with, after which no more tasks are started.
+     */
+    void for_each(const std::size_t n, const std::size_t group, auto&& fn) {
+        std::size_t next = 0;
+        std::exception_ptr error;
+        // Every worker runs the tasks of the next indices one after the other.
+        const auto worker = [&]() -> Task<> {
+            while (next < n) {
+                try {
+                    co_await fn(next++);
+                } catch (...) {
+                    error = error ? error : std::current_exception();
+                    next = n;
+                }
+            }
+        };
+        std::vector<Task<>> workers;
+        for (std::size_t idx = 0; idx < std::min(n, std::max<std::size_t>(group, 1)); idx++) {
+            workers.push_back(worker());
+            spawn(workers.back());
+        }
+        run();
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+   private:
+    /// @brief Queues a coroutine at the back, growing the ring of the queue when it is full.
+    void push(const std::coroutine_handle<> handle) {
+        if (tail_ - head_ == ready_.size()) {
+            std::vector<std::coroutine_handle<>> ring(std::max<std::size_t>(2 * ready_.size(), 64));
+            for (auto idx = head_; idx != tail_; idx++) {
+                ring[idx - head_] = ready_[idx & (ready_.size() - 1)];
+            }
+            tail_ -= head_;
+            head_ = 0;
+            ready_ = std::move(ring);
+        }
+        ready_[tail_++ & (ready_.size() - 1)] = handle;
+    }
+
+    // Ring of the queued coroutines, whose size is a power of two.
+    std::vector<std::coroutine_handle<>> ready_;
+    std::size_t head_{};
+    std::size_t tail_{};
+};
+
+/**
+ * @brief Instruction sets of the batched search kernels.
+ */
+enum class Simd : std::uint8_t { scalar, avx2, avx512 };
+
+// Default number of elements between the prefetch and the processing of an element.
+inline constexpr std::size_t prefetch_window = 16;
+
+/**
+ * @brief Detects the widest instruction set of the batched search kernels that the CPU supports.
+ * The detection runs once and is cached.
+ * @return The instruction set used by the batched searches.
+ */
+[[nodiscard]] inline auto simd() noexcept -> Simd {
+#if defined(BF_HAS_X86_SIMD)
+    static const auto level = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f") != 0) {
+            return Simd::avx512;
+        }
+        if (__builtin_cpu_supports("avx2") != 0) {
+            return Simd::avx2;
+        }
+        return Simd::scalar;
+    }();
+    return level;
+#else
+    return Simd::scalar;
+#endif
+}
+
+namespace detail {
+
+// Number of elements which are hashed ahead of a batched search.
+inline constexpr std::size_t batch_size = 64;
+
+/**
+ * @brief Searches a batch of hashed elements in a bit array. The probes of an element are not
+ * cut short on the first cleared bit, which keeps the loop free of unpredictable branches.
+ * @param words Words of the bit array.
+ * @param bits Number of bits in the bit array.
+ * @param hash_fns Number of hash functions.
+ * @param probes Probes of the elements.
+ * @param n Number of elements.
+ * @param res Output, one byte per element which is one if the element was present and zero
+ * otherwise.
+ */
+template <typename Reducer>
+void search_batch_scalar(const std::uint64_t* words, const std::size_t bits,
+                         const std::uint64_t hash_fns, const Probes* probes, const std::size_t n,
+                         std::uint8_t* res) noexcept {
+    for (std::size_t el = 0; el < n; el++) {
+        auto pos = probes[el].h1;
+        std::uint64_t miss = 0;
+        for (std::uint64_t idx = 0; idx < hash_fns; idx++) {
+            const auto bit = Reducer::reduce(pos, bits);
+            miss |= ~words[bit / 64] & (std::uint64_t{1} << (bit % 64));
+            pos += probes[el].h2;
+        }
+        res[el] = static_cast<std::uint8_t>(miss == 0);
+    }
+}
+
+#if defined(BF_HAS_X86_SIMD)
+
+/// @brief Computes the high halves of the lane-wise 128-bit products of 64-bit integers.
+__attribute__((target("avx2"))) inline auto mulhi_avx2(const __m256i a, const __m256i b) noexcept
+    -> __m256i {
+    const auto mask = _mm256_set1_epi64x(0xffffffff);
+    const auto a_hi = _mm256_srli_epi64(a, 32);
+    const auto b_hi = _mm256_srli_epi64(b, 32);
+    const auto lo_lo = _mm256_mul_epu32(a, b);
+    const auto hi_lo = _mm256_mul_epu32(a_hi, b);
+    const auto lo_hi = _mm256_mul_epu32(a, b_hi);
+    const auto hi_hi = _mm256_mul_epu32(a_hi, b_hi);
+    const auto cross = _mm256_add_epi64(
+        _mm256_add_epi64(_mm256_srli_epi64(lo_lo, 32), _mm256_and_si256(hi_lo, mask)), lo_hi);
+    return _mm256_add_epi64(_mm256_add_epi64(hi_hi, _mm256_srli_epi64(hi_lo, 32)),
+                            _mm256_srli_epi64(cross, 32));
+}
+
+/// @brief Computes the mask of a split block, one bit per 32-bit word, of a key.
+__attribute__((target("avx2"))) inline auto split_block_mask_avx2(
+    const std::uint32_t key, const std::uint32_t* salts) noexcept -> __m256i {
+    const auto salt = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(salts));
+    const auto prod = _mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(key)), salt);
+    return _mm256_sllv_epi32(_mm256_set1_epi32(1), _mm256_srli_epi32(prod, 27));
+}
+
+/// @brief Sets the bits of a key in a split block with AVX2.
+__attribute__((target("avx2"))) inline void split_block_insert_avx2(
+    std::uint32_t* block, const std::uint32_t key, const std::uint32_t* salts) noexcept {
+    auto* ptr = reinterpret_cast<__m256i*>(block);
+    _mm256_store_si256(ptr, _mm256_or_si256(_mm256_load_si256(ptr),
+                                            split_block_mask_avx2(key, salts)));
+}
+
+/// @brief Checks the bits of a key in a split block with AVX2.
+__attribute__((target("avx2"))) inline auto split_block_check_avx2(
+    const std::uint32_t* block, const std::uint32_t key, const std::uint32_t* salts) noexcept
+    -> bool {
+    const auto word = _mm256_load_si256(reinterpret_cast<const __m256i*>(block));
+    return _mm256_testc_si256(word, split_block_mask_avx2(key, salts)) != 0;
+}
+
+// The AVX-512 intrinsics of GCC 12 trip -Wmaybe-uninitialized (GCC bug 105593).
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+/// @brief Computes the high halves of the lane-wise 128-bit products of 64-bit integers.
+__attribute__((target("avx512f"))) inline auto mulhi_avx512(const __m512i a,
+                                                             const __m512i b) noexcept -> __m512i {
+    const auto mask = _mm512_set1_epi64(0xffffffff);
+    const auto a_hi = _mm512_srli_epi64(a, 32);
+    const auto b_hi = _mm512_srli_epi64(b, 32);
+    const auto lo_lo = _mm512_mul_epu32(a, b);
+    const auto hi_lo = _mm512_mul_epu32(a_hi, b);
+    const auto lo_hi = _mm512_mul_epu32(a, b_hi);
+    const auto hi_hi = _mm512_mul_epu32(a_hi, b_hi);
+    const auto cross = _mm512_add_epi64(
+        _mm512_add_epi64(_mm512_srli_epi64(lo_lo, 32), _mm512_and_si512(hi_lo, mask)), lo_hi);
+    return _mm512_add_epi64(_mm512_add_epi64(hi_hi, _mm512_srli_epi64(hi_lo, 32)),
+                            _mm512_srli_epi64(cross, 32));
+}
+
+/**
+ * @brief Searches a batch of hashed elements in a bit array, four elements at a time. The words
+ * of the probes are gathered and tested with AVX2 and a group stops as soon as all of its
+ * elements are known to be missing.
+ */
+template <typename Reducer>
+__attribute__((target("avx2"))) void search_batch_avx2(const std::uint64_t* words,
+                                                       const std::size_t bits,
+                                                       const std::uint64_t hash_fns,
+                                                       const Probes* probes, const std::size_t n,
+                                                       std::uint8_t* res) noexcept {
+    const auto size = _mm256_set1_epi64x(static_cast<long long>(bits));
+    const auto mask = _mm256_set1_epi64x(static_cast<long long>(bits - 1));
+    const auto low = _mm256_set1_epi64x(63);
+    const auto one = _mm256_set1_epi64x(1);
+    const auto zero = _mm256_setzero_si256();
+    const auto* base = reinterpret_cast<const long long*>(words);
+
+    std::size_t el = 0;
+    for (; el + 4 <= n; el += 4) {
+        // `Probes` is a pair of words, so that a group of four is two registers of `h1, h2` pairs.
+        const auto lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(probes + el));
+        const auto hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(probes + el + 2));
+        auto pos = _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(lo, hi), 0b11'01'10'00);
+        const auto step = _mm256_permute4x64_epi64(_mm256_unpackhi_epi64(lo, hi), 0b11'01'10'00);
+
+        auto miss = zero;
+        for (std::uint64_t idx = 0; idx < hash_fns; idx++) {
+            const auto bit = std::same_as<Reducer, PowerOfTwo> ? _mm256_and_si256(pos, mask)
+                                                               : mulhi_avx2(pos, size);
+            const auto word = _mm256_i64gather_epi64(base, _mm256_srli_epi64(bit, 6), 8);
+            const auto test = _mm256_sllv_epi64(one, _mm256_and_si256(bit, low));
+            miss = _mm256_or_si256(miss, _mm256_andnot_si256(word, test));
+            if (_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(miss, zero))) == 0) {
+                break;
+            }
+            pos = _mm256_add_epi64(pos, step);
+        }
+
+        const auto found = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(miss, zero)));
+        for (std::size_t lane = 0; lane < 4; lane++) {
+            res[el + lane] = static_cast<std::uint8_t>((found >> lane) & 1);
+        }
+    }
+    search_batch_scalar<Reducer>(words, bits, hash_fns, probes + el, n - el, res + el);
+}
+
+/**
+ * @brief Searches a batch of hashed elements in a bit array, eight elements at a time, with
+ * AVX-512. See `search_batch_avx2`.
+ */
+template <typename Reducer>
+__attribute__((target("avx512f"))) void search_batch_avx512(const std::uint64_t* words,
+                                                            const std::size_t bits,
+                                                            const std::uint64_t hash_fns,
+                                                            const Probes* probes,
+                                                            const std::size_t n,
+                                                            std::uint8_t* res) noexcept {
+    const auto size = _mm512_set1_epi64(static_cast<long long>(bits));
+    const auto mask = _mm512_set1_epi64(static_cast<long long>(bits - 1));
+    const auto low = _mm512_set1_epi64(63);
+    const auto one = _mm512_set1_epi64(1);
+    const auto even = _mm512_set_epi64(14, 12, 10, 8, 6, 4, 2, 0);
+    const auto odd = _mm512_set_epi64(15, 13, 11, 9, 7, 5, 3, 1);
+
+    std::size_t el = 0;
+    for (; el + 8 <= n; el += 8) {
+        const auto lo = _mm512_loadu_si512(probes + el);
+        const auto hi = _mm512_loadu_si512(probes + el + 4);
+        auto pos = _mm512_permutex2var_epi64(lo, even, hi);
+        const auto step = _mm512_permutex2var_epi64(lo, odd, hi);
+
+        __mmask8 found = 0xff;
+        for (std::uint64_t idx = 0; idx < hash_fns && found != 0; idx++) {
+            const auto bit = std::same_as<Reducer, PowerOfTwo> ? _mm512_and_si512(pos, mask)
+                                                               : mulhi_avx512(pos, size);
+            const auto word = _mm512_mask_i64gather_epi64(_mm512_setzero_si512(), found,
+                                                          _mm512_srli_epi64(bit, 6), words, 8);
+            const auto test = _mm512_sllv_epi64(one, _mm512_and_si512(bit, low));
+            found = _mm512_mask_test_epi64_mask(found, word, test);
+            pos = _mm512_add_epi64(pos, step);
+        }
+
+        for (std::size_t lane = 0; lane < 8; lane++) {
+            res[el + lane] = static_cast<std::uint8_t>((found >> lane) & 1);
+        }
+    }
+    search_batch_scalar<Reducer>(words, bits, hash_fns, probes + el, n - el, res + el);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif
+
+/**
+ * @brief Searches a batch of hashed elements with the widest kernel that the CPU supports.
+ * Kernels other than the scalar one are only available for the built-in range reductions.
+ */
+template <typename Reducer>
+void search_batch(const std::uint64_t* words, const std::size_t bits,
+                  const std::uint64_t hash_fns, const Probes* probes, const std::size_t n,
+                  std::uint8_t* res) noexcept {
+#if defined(BF_HAS_X86_SIMD)
+    if constexpr (std::same_as<Reducer, FastRange> || std::same_as<Reducer, PowerOfTwo>) {
+        switch (simd()) {
+            case Simd::avx512:
+                return search_batch_avx512<Reducer>(words, bits, hash_fns, probes, n, res);
+            case Simd::avx2:
+                return search_batch_avx2<Reducer>(words, bits, hash_fns, probes, n, res);
+            case Simd::scalar:
+                break;
+        }
+    }
+#endif
+    search_batch_scalar<Reducer>(words, bits, hash_fns, probes, n, res);
+}
+
+#if defined(BF_HAS_X86_SIMD)
+/// @brief Combines words with AVX2, four words at a time, followed by the remaining words.
+template <typename Op>
+__attribute__((target("avx2"))) void combine_words_avx2(std::uint64_t* dst,
+                                                        const std::uint64_t* src,
+                                                        const std::size_t n) noexcept {
+    std::size_t idx = 0;
+    for (; idx + 4 <= n; idx += 4) {
+        auto* out = reinterpret_cast<__m256i*>(dst + idx);
+        const auto lhs = _mm256_loadu_si256(out);
+        const auto rhs = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + idx));
+        if constexpr (std::same_as<Op, std::bit_or<>>) {
+            _mm256_storeu_si256(out, _mm256_or_si256(lhs, rhs));
+        } else {
+            _mm256_storeu_si256(out, _mm256_and_si256(lhs, rhs));
+        }
+    }
+    for (; idx < n; idx++) {
+        dst[idx] = Op{}(dst[idx], src[idx]);
+    }
+}
+#endif
+
+/**
+ * @brief Combines words in place with a bitwise operation, with the widest vectors that the CPU
+ * supports.
+ * @param dst Words which are combined in place.
+ * @param src Words which are combined into `dst`.
+ * @param n Number of words.
+ */
+template <typename Op>
+void combine_words(std::uint64_t* dst, const std::uint64_t* src, const std::size_t n) noexcept {
+#if defined(BF_HAS_X86_SIMD)
+    if (simd() != Simd::scalar) {
+        return combine_words_avx2<Op>(dst, src, n);
+    }
+#endif
+    for (std::size_t idx = 0; idx < n; idx++) {
+        dst[idx] = Op{}(dst[idx], src[idx]);
+    }
+}
+
+#if defined(BF_HAS_X86_SIMD)
+/// @brief Counts the set bits of words with the `popcnt` instruction.
+__attribute__((target("popcnt"))) inline auto popcount_words_popcnt(
+    const std::uint64_t* words, const std::size_t n) noexcept -> std::uint64_t {
+    std::uint64_t res = 0;
+    for (std::size_t idx = 0; idx < n; idx++) {
+        res += static_cast<std::uint64_t>(std::popcount(words[idx]));
+    }
+    return res;
+}
+#endif
+
+/**
+ * @brief Counts the set bits of words.
+ * @param words Words to be counted.
+ * @param n Number of words.
+ * @return The number of set bits.
+ */
+inline auto popcount_words(const std::uint64_t* words, const std::size_t n) noexcept
+    -> std::uint64_t {
+#if defined(BF_HAS_X86_SIMD)
+    // Every CPU with AVX2 has `popcnt`, which the baseline x86-64 target does not assume.
+    if (simd() != Simd::scalar) {
+        return popcount_words_popcnt(words, n);
+    }
+#endif
+    std::uint64_t res = 0;
+    for (std::size_t idx = 0; idx < n; idx++) {
+        res += static_cast<std::uint64_t>(std::popcount(words[idx]));
+    }
+    return res;
+}
+
+/**
+ * @brief Checks that two filters have the same parameters, which is required to combine them.
+ * @throws std::invalid_argument If the parameters differ.
+ */
+inline void check_combinable(const std::size_t bits, const std::uint64_t hash_fns,
+                             const std::size_t other_bits, const std::uint64_t other_hash_fns) {
+    if (bits != other_bits || hash_fns != other_hash_fns) {
+        throw std::invalid_argument(
+            "Filters must have the same number of bits and hash functions.");
+    }
+}
+
+/**
+ * @brief Computes the optimal number of bits and hash functions of a bloom filter.
+ * @param elems An approximate number of elements to be inserted.
+ * @param eps False positive probability.
+ * @return The number of bits, rounded by `Reducer`, and the number of hash functions.
+ */
+template <typename Reducer>
+[[nodiscard]] auto optimal_parameters(const std::uint64_t elems,
+                                      const std::floating_point auto eps)
+    -> std::pair<std::size_t, std::uint64_t> {
+    if (elems <= 0) {
+        throw std::domain_error("Number of elements must be greater than zero.");
+    }
+    if (eps <= 0 || eps >= 1) {
+        throw std::domain_error("False positive probability must be between zero and one.");
+    }
+
+    // The number of hash functions is derived from the final number of bits, so that it stays
+    // optimal when the reduction rounds the number of bits up.
+    const std::size_t bits =
+        Reducer::size(-std::ceil(elems * std::log(eps) / std::pow(std::log(2), 2)));
+    const std::uint64_t hash_fns =
+        std::ceil(static_cast<float>(bits) / static_cast<float>(elems) * std::log(2));
+    return {bits, hash_fns};
+}
+
+/**
+ * @brief Computes the natural logarithm of a positive number in constant expressions, where
+ * `std::log` is not available until C++26.
+ * @param x A positive number.
+ * @return The natural logarithm of `x`.
+ */
+[[nodiscard]] constexpr auto log(double x) noexcept -> double {
+    constexpr double ln2 = 0.693147180559945309417232121458176568;
+    double exp = 0;
+    for (; x >= 2; x /= 2) {
+        exp++;
+    }
+    for (; x < 1; x *= 2) {
+        exp--;
+    }
+    // ln(x) = 2 atanh((x - 1) / (x + 1)), whose series converges quickly for x in [1, 2).
+    const auto z = (x - 1) / (x + 1);
+    double res = 0;
+    double term = z;
+    for (int n = 1; n < 64; n += 2) {
+        res += term / n;
+        term *= z * z;
+    }
+    return 2 * res + exp * ln2;
+}
+
+/// @brief Rounds a non-negative number up to an integer in constant expressions.
+[[nodiscard]] constexpr auto ceil(const double x) noexcept -> std::uint64_t {
+    const auto res = static_cast<std::uint64_t>(x);
+    return static_cast<double>(res) < x ? res + 1 : res;
+}
+
+/**
+ * @brief Checks if a hashed element is likely to be in a bit array.
+ * @param words Words of the bit array.
+ * @param bits Number of bits in the bit array.
+ * @param hash_fns Number of hash functions.
+ * @param hash Hash of the element.
+ * @return A boolean value specifying whether the element was present or not.
+ */
+template <typename Reducer>
+[[nodiscard]] constexpr auto search_words(const std::uint64_t* words, const std::size_t bits,
+                                          const std::uint64_t hash_fns,
+                                          const std::uint64_t hash) noexcept -> bool {
+    const auto probes = Probes{hash};
+    for (std::size_t idx = 0; idx < hash_fns; idx++) {
+        const auto bit = Reducer::reduce(probes[idx], bits);
+        if (((words[bit / BitArray::word_bits] >> (bit % BitArray::word_bits)) & 1) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Hashes the elements of an iterable in batches.
+ * @param hasher Hash function.
+ * @param it An iterable containing elements to be hashed.
+ * @param fn Function which is called with the probes of every batch and the size of the batch.
+ */
+void for_each_batch(const auto& hasher, const auto& it, auto&& fn) {
+    std::array<Probes, batch_size> probes{};
+    std::size_t n = 0;
+    for (const auto& el : it) {
+        probes[n++] = Probes{hasher(el)};
+        if (n == probes.size()) {
+            fn(probes.data(), n);
+            n = 0;
+        }
+    }
+    if (n != 0) {
+        fn(probes.data(), n);
+    }
+}
+
+// Identifier of a policy in serialized filters, zero for the policies which do not have one.
+template <typename Policy>
+inline constexpr std::uint32_t policy_id = [] {
+    if constexpr (requires { Policy::id; }) {
+        return std::uint32_t{Policy::id};
+    } else {
+        return std::uint32_t{0};
+    }
+}();
+
+/**
+ * @brief Layouts of the bit vector in serialized filters: that of `BloomFilter`, of
+ * `BlockedBloomFilter`, and of `SplitBlockBloomFilter`.
+ */
+enum class Layout : std::uint16_t { standard = 1, blocked = 2, split_block = 3 };
+
+/**
+ * @brief Encodings of the bit vector in serialized filters.
+ */
+enum class Encoding : std::uint16_t { raw = 0, elias_fano = 1 };
+
+/// @brief Seed of a hasher in serialized filters, zero for the hashers which do not have one.
+template <typename Hasher>
+[[nodiscard]] constexpr auto hasher_seed(const Hasher& hash) noexcept -> std::uint64_t {
+    if constexpr (requires { std::uint64_t{hash.seed}; }) {
+        return hash.seed;
+    } else {
+        return 0;
+    }
+}
+
+/**
+ * @brief Header of a serialized filter. The header is followed by the words of the bit vector, as
+ * is or encoded, and both are stored in little-endian byte order. The header takes up a whole cache
+ * line, so that the words of a memory-mapped filter are aligned.
+ */
+struct Header {
+    // Magic number, the bytes of "bf.bloom".
+    static constexpr std::uint64_t file_magic = read<8>("bf.bloom");
+    // Version of the format.
+    static constexpr std::uint32_t file_version = 1;
+
+    std::uint64_t magic{file_magic};
+    std::uint32_t version{file_version};
+    Layout layout{};
+    Encoding encoding{};
+    std::uint64_t bits{};
+    std::uint64_t hash_fns{};
+    std::uint64_t words{};
+    std::uint32_t hasher{};
+    std::uint32_t reducer{};
+    // Hash of the words of the bit vector, before they are encoded.
+    std::uint64_t checksum{};
+    // Seed of the hasher, without which the filter would be read with different hashes.
+    std::uint64_t seed{};
+
+    /**
+     * @brief Checks that a filter with this header can be read by a filter of the provided layout
+     * and policies.
+     */
+    void validate(const Layout expected, const std::uint32_t hasher_id,
+                  const std::uint32_t reducer_id, const std::uint64_t hasher_seed) const {
+        if (magic != file_magic) {
+            throw std::runtime_error("Input is not a serialized bloom filter.");
+        }
+        if (version != file_version) {
+            throw std::runtime_error("Unsupported version of the serialized bloom filter.");
+        }
+        if (layout != expected) {
+            throw std::runtime_error("Layout of the serialized bloom filter does not match.");
+        }
+        if (hasher != hasher_id || reducer != reducer_id) {
+            throw std::runtime_error("Policies of the serialized bloom filter do not match.");
+        }
+        if (seed != hasher_seed) {
+            throw std::runtime_error("Seed of the serialized bloom filter does not match.");
+        }
+        if (bits == 0 || hash_fns == 0 || !consistent() ||
+            (encoding != Encoding::raw && encoding != Encoding::elias_fano)) {
+            throw std::runtime_error("Serialized bloom filter is corrupt.");
+        }
+    }
+
+    /// @brief Whether the numbers of bits, words, and hash functions fit the layout.
+    [[nodiscard]] constexpr auto consistent() const noexcept -> bool {
+        // The number of words of a number of bits close to the largest integer would wrap around.
+        if (words > std::numeric_limits<std::uint64_t>::max() / BitArray::word_bits ||
+            bits > words * BitArray::word_bits) {
+            return false;
+        }
+        switch (layout) {
+            case Layout::standard:
+                return words == BitArray::words_for(bits);
+            case Layout::blocked:
+                // Blocks of 512 bits and at most 64 hash functions.
+                return bits % 512 == 0 && words == bits / 64 && hash_fns <= 64;
+            case Layout::split_block:
+                // Blocks of 256 bits, with one bit in every 32-bit word of a block.
+                return bits % 256 == 0 && words == bits / 64 && hash_fns == 8;
+        }
+        return false;
+    }
+};
+
+static_assert(sizeof(Header) == BitArray::alignment);
+
+/// @brief Hashes the words of a bit vector.
+[[nodiscard]] inline auto checksum(const std::uint64_t* words, const std::size_t n) noexcept
+    -> std::uint64_t {
+    return wyhash(reinterpret_cast<const unsigned char*>(words), n * sizeof(std::uint64_t), 0);
+}
+
+/**
+ * @brief Elias-Fano code of the positions of the set bits of a bit vector (Elias, 1974; Fano,
+ * 1971). Every position is split into its `low_bits` low bits, which are stored as is, and its
+ * high bits, which are stored as the gaps between them in unary. This takes about
+ * `2 + log2(bits / ones)` bits per set bit, which is less than the bits themselves for bit vectors
+ * with less than about a fifth of their bits set. The code is written as the number of set bits,
+ * `low_bits`, the words of the low bits, and the words of the high bits.
+ */
+struct EliasFano {
+    // Number of set bits.
+    std::uint64_t ones{};
+    // Number of low bits of every position.
+    std::uint64_t low_bits{};
+    // Number of words of the low bits.
+    std::uint64_t low_words{};
+    // Number of words of the high bits, which hold one bit per position and one per bucket.
+    std::uint64_t high_words{};
+
+    /**
+     * @brief Computes the sizes of the code of a bit vector.
+     * @param bits Number of bits in the bit vector.
+     * @param set Number of set bits.
+     */
+    EliasFano(const std::uint64_t bits, const std::uint64_t set) noexcept
+        : ones{set}, low_bits{std::bit_width(bits / std::max<std::uint64_t>(set, 1)) - 1ULL} {
+        low_words = (ones * low_bits + 63) / 64;
+        high_words = (ones + (bits >> low_bits) + 1 + 63) / 64;
+    }
+
+    /// @brief Number of words of the code, including its two leading words.
+    [[nodiscard]] auto words() const noexcept -> std::uint64_t {
+        return 2 + low_words + high_words;
+    }
+};
+
+/**
+ * @brief Writes the Elias-Fano code of a bit vector to a stream.
+ * @param os Output stream.
+ * @param words Words of the bit vector.
+ * @param n Number of words.
+ * @param code Sizes of the code, from the number of bits and set bits of the bit vector.
+ */
+inline void write_elias_fano(std::ostream& os, const std::uint64_t* words, const std::size_t n,
+                             const EliasFano& code) {
+    std::vector<std::uint64_t> out(code.words(), 0);
+    out[0] = code.ones;
+    out[1] = code.low_bits;
+    auto* const low = out.data() + 2;
+    auto* const high = low + code.low_words;
+    const auto low_mask = (std::uint64_t{1} << code.low_bits) - 1;
+    std::uint64_t rank = 0;
+    for (std::size_t idx = 0; idx < n; idx++) {
+        for (auto word = words[idx]; word != 0; word &= word - 1) {
+            const auto pos = idx * 64 + static_cast<std::uint64_t>(std::countr_zero(word));
+            if (code.low_bits != 0) {
+                // The low bits of a position straddle at most two words.
+                const auto offset = rank * code.low_bits;
+                low[offset / 64] |= (pos & low_mask) << (offset % 64);
+                if (offset % 64 + code.low_bits > 64) {
+                    low[offset / 64 + 1] |= (pos & low_mask) >> (64 - offset % 64);
+                }
+            }
+            const auto unary = (pos >> code.low_bits) + rank;
+            high[unary / 64] |= std::uint64_t{1} << (unary % 64);
+            rank++;
+        }
+    }
+    os.write(reinterpret_cast<const char*>(out.data()),
+             static_cast<std::streamsize>(out.size() * sizeof(std::uint64_t)));
+}
+
+/**
+ * @brief Reads the Elias-Fano code of a bit vector from a stream and sets its bits in the words
+ * of the bit vector, which must be zero.
+ * @param is Input stream.
+ * @param header Header of the filter.
+ * @param words Words of the bit vector.
+ */
+inline void read_elias_fano(std::istream& is, const Header& header, std::uint64_t* words) {
+    std::array<std::uint64_t, 2> sizes{};
+    if (!is.read(reinterpret_cast<char*>(sizes.data()), sizeof(sizes))) {
+        throw std::runtime_error("Failed to read the bloom filter.");
+    }
+    if (sizes[0] > header.bits) {
+        throw std::runtime_error("Serialized bloom filter is corrupt.");
+    }
+    const auto code = EliasFano{header.bits, sizes[0]};
+    if (sizes[1] != code.low_bits) {
+        throw std::runtime_error("Serialized bloom filter is corrupt.");
+    }
+    std::vector<std::uint64_t> in(code.low_words + code.high_words);
+    if (!is.read(reinterpret_cast<char*>(in.data()),
+                 static_cast<std::streamsize>(in.size() * sizeof(std::uint64_t)))) {
+        throw std::runtime_error("Failed to read the bloom filter.");
+    }
+
+    const auto* const low = in.data();
+    const auto* const high = low + code.low_words;
+    const auto low_mask = (std::uint64_t{1} << code.low_bits) - 1;
+    std::uint64_t rank = 0;
+    for (std::uint64_t idx = 0; idx < code.high_words; idx++) {
+        for (auto word = high[idx]; word != 0; word &= word - 1) {
+            const auto unary = idx * 64 + static_cast<std::uint64_t>(std::countr_zero(word));
+            if (rank == code.ones || unary < rank) {
+                throw std::runtime_error("Serialized bloom filter is corrupt.");
+            }
+            auto pos = (unary - rank) << code.low_bits;
+            if (code.low_bits != 0) {
+                const auto offset = rank * code.low_bits;
+                auto value = low[offset / 64] >> (offset % 64);
+                if (offset % 64 + code.low_bits > 64) {
+                    value |= low[offset / 64 + 1] << (64 - offset % 64);
+                }
+                pos |= value & low_mask;
+            }
+            if (pos >= header.bits) {
+                throw std::runtime_error("Serialized bloom filter is corrupt.");
+            }
+            words[pos / 64] |= std::uint64_t{1} << (pos % 64);
+            rank++;
+        }
+    }
+    if (rank != code.ones) {
+        throw std::runtime_error("Serialized bloom filter is corrupt.");
+    }
+    if (checksum(words, header.words) != header.checksum) {
+        throw std::runtime_error("Checksum of the serialized bloom filter does not match.");
+    }
+}
+
+/**
+ * @brief Writes a filter to a stream.
+ * @param os Output stream.
+ * @param header Header of the filter, whose checksum is filled in.
+ * @param words Words of the bit vector.
+ */
+inline void write(std::ostream& os, Header header, const std::uint64_t* words) {
+    static_assert(std::endian::native == std::endian::little,
+                  "Serialization is only supported on little-endian targets.");
+    header.checksum = checksum(words, header.words);
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (header.encoding == Encoding::elias_fano) {
+        const auto ones = popcount_words(words, header.words);
+        write_elias_fano(os, words, header.words, EliasFano{header.bits, ones});
+    } else {
+        os.write(reinterpret_cast<const char*>(words),
+                 static_cast<std::streamsize>(header.words * sizeof(std::uint64_t)));
+    }
+    if (!os) {
+        throw std::runtime_error("Failed to write the bloom filter.");
+    }
+}
+
+/**
+ * @brief Reads the header of a filter from a stream.
+ * @param is Input stream.
+ * @return The header.
+ */
+[[nodiscard]] inline auto read_header(std::istream& is) -> Header {
+    static_assert(std::endian::native == std::endian::little,
+                  "Serialization is only supported on little-endian targets.");
+    Header header{};
+    if (!is.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        throw std::runtime_error("Failed to read the bloom filter.");
+    }
+    return header;
+}
+
+/**
+ * @brief Reads the words of a filter from a stream and checks them against the checksum.
+ * @param is Input stream.
+ * @param header Header of the filter.
+ * @param words Words of the bit vector.
+ */
+inline void read_words(std::istream& is, const Header& header, std::uint64_t* words) {
+    if (header.encoding == Encoding::elias_fano) {
+        read_elias_fano(is, header, words);
+        return;
+    }
+    if (!is.read(reinterpret_cast<char*>(words),
+                 static_cast<std::streamsize>(header.words * sizeof(std::uint64_t)))) {
+        throw std::runtime_error("Failed to read the bloom filter.");
+    }
+    if (checksum(words, header.words) != header.checksum) {
+        throw std::runtime_error("Checksum of the serialized bloom filter does not match.");
+    }
+}
+
+/**
+ * @brief Views a word of a bit array as an atomic object.
+ * @param bvec Bit array.
+ * @param idx Index of the word.
+ * @return An atomic reference to the word.
+ */
+[[nodiscard]] inline auto atomic_word(const auto& bvec, const std::size_t idx) noexcept {
+    // The words are never const objects, the const is only that of the filter.
+    return std::atomic_ref<std::uint64_t>{const_cast<std::uint64_t*>(bvec.data())[idx]};
+}
+
+/**
+ * @brief Inserts a hashed element into a bit array with relaxed atomic operations. The
+ * read-modify-write is skipped for the words in which the bit is already set.
+ * @param bvec Bit array.
+ * @param bits Number of bits in the bit array.
+ * @param hash_fns Number of hash functions.
+ * @param hash Hash of the element.
+ */
+template <typename Reducer>
+void insert_atomic(auto& bvec, const std::size_t bits, const std::uint64_t hash_fns,
+                   const std::uint64_t hash) noexcept {
+    const auto probes = Probes{hash};
+    for (std::size_t idx = 0; idx < hash_fns; idx++) {
+        const auto bit = Reducer::reduce(probes[idx], bits);
+        const auto mask = std::uint64_t{1} << (bit % BitArray::word_bits);
+        auto word = atomic_word(bvec, bit / BitArray::word_bits);
+        if ((word.load(std::memory_order_relaxed) & mask) == 0) {
+            word.fetch_or(mask, std::memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Clears a bit array in place in parallel, one range of cache lines per chunk.
+ * @param bvec Bit array.
+ * @param ex Executor which runs the chunks.
+ */
+void clear_parallel(auto& bvec, executor auto& ex) {
+    constexpr auto line_words = BitArray::line_words;
+    const auto stream = bvec.words() * sizeof(std::uint64_t) >= stream_bytes;
+    ex.parallel_for(bvec.words() / line_words, [&](const std::size_t begin, const std::size_t end) {
+        zero_words(bvec.data() + begin * line_words, (end - begin) * line_words, stream);
+    });
+}
+
+/**
+ * @brief Combines a bit array into another in place in parallel, one range of cache lines per
+ * chunk.
+ * @param dst Bit array which is combined in place.
+ * @param src Bit array which is combined into `dst`, of the same size.
+ * @param ex Executor which runs the chunks.
+ */
+template <typename Op>
+void combine_parallel(auto& dst, const auto& src, executor auto& ex) {
+    constexpr auto line_words = BitArray::line_words;
+    ex.parallel_for(dst.words() / line_words, [&](const std::size_t begin, const std::size_t end) {
+        combine_words<Op>(dst.data() + begin * line_words, src.data() + begin * line_words,
+                          (end - begin) * line_words);
+    });
+}
+
+/**
+ * @brief Prefetches the cache line of the provided address into all levels of the cache.
+ * @param ptr Address to be prefetched.
+ */
+template <bool Write>
+inline void prefetch(const void* ptr) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(ptr, Write ? 1 : 0, 3);
+#else
+    static_cast<void>(ptr);
+#endif
+}
+
+/**
+ * @brief Runs a software pipeline over the elements of an iterable. Every element is hashed and
+ * its memory is prefetched `window` elements before the element is processed, which keeps up to
+ * `window` cache misses in flight.
+ * @param it An iterable containing elements to be processed.
+ * @param window Number of elements between the prefetch and the processing of an element.
+ * @param hash Function which hashes an element.
+ * @param fetch Function which prefetches the memory of a hashed element.
+ * @param fn Function which processes a hashed element, in the order of the iterable.
+ */
+void pipeline(const auto& it, const std::size_t window, auto&& hash, auto&& fetch, auto&& fn) {
+    const auto ahead = std::max<std::size_t>(window, 1);
+    auto ring = std::vector<std::uint64_t>(std::bit_ceil(ahead));
+    const auto mask = ring.size() - 1;
+    std::size_t head = 0;
+    std::size_t tail = 0;
+    for (const auto& el : it) {
+        if (head - tail == ahead) {
+            fn(ring[tail++ & mask]);
+        }
+        ring[head & mask] = hash(el);
+        fetch(ring[head++ & mask]);
+    }
+    while (tail != head) {
+        fn(ring[tail++ & mask]);
+    }
+}
+
+}  // namespace detail
+
+/**
+ * @brief Compression of the bit vector of a saved filter. `elias_fano` encodes the positions of
+ * the set bits, which is smaller for sparse filters, such as over-provisioned ones, and larger for
+ * full ones; `automatic` picks whichever of the two is smaller, which depends on the fill ratio.
+ * Only uncompressed filters can be memory-mapped.
+ */
+enum class Compression { none, elias_fano, automatic };
+
+namespace detail {
+
+/**
+ * @brief Chooses the encoding of the bit vector of a saved filter.
+ * @param compression Compression of the bit vector.
+ * @param bits Number of bits in the bit vector.
+ * @param words Words of the bit vector.
+ * @param n Number of words.
+ * @return The encoding.
+ */
+[[nodiscard]] inline auto encoding_for(const Compression compression, const std::uint64_t bits,
+                                       const std::uint64_t* words, const std::size_t n) noexcept
+    -> Encoding {
+    if (compression == Compression::none) {
+        return Encoding::raw;
+    }
+    const auto code = EliasFano{bits, popcount_words(words, n)};
+    if (compression == Compression::elias_fano || code.words() < n) {
+        return Encoding::elias_fano;
+    }
+    return Encoding::raw;
+}
+
+}  // namespace detail
+
+/**
+ * @brief The default statistics policy of `BloomFilter`, which counts nothing and costs nothing.
+ */
+struct NoStats {
+    // Whether the policy counts anything.
+    static constexpr bool enabled = false;
+
+    constexpr void insert(const std::uint64_t /*n*/) const noexcept {}
+
+    constexpr void search(const std::uint64_t /*n*/,
+                          const std::uint64_t /*positives*/) const noexcept {}
+};
+
+/**
+ * @brief A statistics policy of `BloomFilter` which counts insertions, lookups, and positive
+ * lookups. The counters are relaxed atomics striped over cache lines by thread, so that threads
+ * which search a shared filter do not contend on a single counter.
+ */
+class StripedStats {
+   public:
+    // Whether the policy counts anything.
+    static constexpr bool enabled = true;
+    // Number of stripes of the counters.
+    static constexpr std::size_t stripes = 16;
+
+    /// @brief Totals of the counters.
+    struct Counts {
+        std::uint64_t inserts{};
+        std::uint64_t searches{};
+        std::uint64_t positives{};
+    };
+
+    StripedStats() = default;
+
+    StripedStats(const StripedStats& other) noexcept {
+        *this = other;
+    }
+
+    auto operator=(const StripedStats& other) noexcept -> StripedStats& {
+        const auto counts = other.counts();
+        reset();
+        slots_[0].inserts.store(counts.inserts, std::memory_order_relaxed);
+        slots_[0].searches.store(counts.searches, std::memory_order_relaxed);
+        slots_[0].positives.store(counts.positives, std::memory_order_relaxed);
+        return *this;
+    }
+
+    ~StripedStats() = default;
+
+    void insert(const std::uint64_t n) const noexcept {
+        slot().inserts.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    void search(const std::uint64_t n, const std::uint64_t positives) const noexcept {
+        auto& counters = slot();
+        counters.searches.fetch_add(n, std::memory_order_relaxed);
+        counters.positives.fetch_add(positives, std::memory_order_relaxed);
+    }
+
+    /// @brief Sums the counters of all of the stripes.
+    [[nodiscard]] auto counts() const noexcept -> Counts {
+        Counts res{};
+        for (const auto& counters : slots_) {
+            res.inserts += counters.inserts.load(std::memory_order_relaxed);
+            res.searches += counters.searches.load(std::memory_order_relaxed);
+            res.positives += counters.positives.load(std::memory_order_relaxed);
+        }
+        return res;
+    }
+
+    /// @brief Resets all of the counters to zero.
+    void reset() noexcept {
+        for (auto& counters : slots_) {
+            counters.inserts.store(0, std::memory_order_relaxed);
+            counters.searches.store(0, std::memory_order_relaxed);
+            counters.positives.store(0, std::memory_order_relaxed);
+        }
+    }
+
+   private:
+    struct alignas(64) Slot {
+        std::atomic<std::uint64_t> inserts{};
+        std::atomic<std::uint64_t> searches{};
+        std::atomic<std::uint64_t> positives{};
+    };
+
+    /// @brief Stripe of the calling thread.
+    [[nodiscard]] auto slot() const noexcept -> Slot& {
+        thread_local const auto idx = std::hash<std::thread::id>{}(std::this_thread::get_id());
+        return slots_[detail::mix64(idx) % stripes];
+    }
+
+    mutable std::array<Slot, stripes> slots_{};
+};
+
+/**
+ * @brief A zero-dependency bloom filter implementation. The data structure provides efficient
+ * data storage and lookup. It is important to note that due to the probabilistic nature of the
+ * data structure, there is a chance for false positive results. In other words, after inserting
+ * data into the bloom filter, a lookup can either tell that the data is present with some
+ * probability of the false positive outcome or tell that the data is definitely not present in
+ * the data structure. The hasher `Hasher` and the range reduction `Reducer` are policies which
+ * are inlined into the probe loop, and the bit vector is allocated with `Allocator`.
+ */
+template <typename Hasher = DefaultHasher, typename Reducer = FastRange,
+          typename Allocator = AlignedAllocator<std::uint64_t>, typename Stats = NoStats>
+struct BloomFilter {
+    // Number of bits in the bit vector.
+    std::size_t bits;
+    // Number of hash functions.
+    std::uint64_t hash_fns;
+    // Bit vector.
+    BasicBitArray<Allocator> bvec;
+    // Hash function.
+    [[no_unique_address]] Hasher hasher;
+    // Counters of insertions and lookups.
+    [[no_unique_address]] Stats stats;
+
+    /**
+     * @brief Creates a new bloom filter with optimal parameters.
+     * @param n An approximate number of elements to be inserted.
+     * @param eps False positive probability.
+     * @param hash Hash function.
+     * @param alloc Allocator of the bit vector.
+     */
+    explicit constexpr BloomFilter(const std::uint64_t elems, const arithmetic auto eps,
+                                   Hasher hash = {}, const Allocator& alloc = {})
+        : BloomFilter{detail::optimal_parameters<Reducer>(elems, eps), hash, alloc} {}
+
+    /**
+     * @brief Inserts a new element into the bloom filter.
+     * @param data Data to be inserted into a bloom filter.
+     */
+    template <hashable_with<Hasher> T>
+    constexpr void insert(const T& data) noexcept {
+        insert_hash(hasher(data));
+    }
+
+    /**
+     * @brief Inserts an element, which has already been hashed with `hasher`, into the bloom
+     * filter.
+     * @param hash Hash of the element.
+     */
+    constexpr void insert_hash(const std::uint64_t hash) noexcept {
+        const auto probes = detail::Probes{hash};
+        for (std::size_t idx = 0; idx < hash_fns; idx++) {
+            bvec.set(Reducer::reduce(probes[idx], bits));
+        }
+        stats.insert(1);
+    }
+
+    /**
+     * @brief Inserts elements from the provided iterable into the bloom filter.
+     * @param it An iterable containing elements to be inserted into the bloom filter.
+     */
+    constexpr void insert_many(iterable auto&& it) noexcept {
+        for (const auto& el : it) {
+            insert(el);
+        }
+    }
+
+    /**
+     * @brief Inserts elements from the provided iterable into the bloom filter. The words of every
+     * element are prefetched `window` elements ahead, which pays off for filters that are much
+     * larger than the last-level cache.
+     * @param it An iterable containing elements to be inserted into the bloom filter.
+     * @param window Number of elements between the prefetch and the insertion of an element.
+     */
+    void insert_many(iterable auto&& it, const std::size_t window) {
+        detail::pipeline(
+            it, window, [&](const auto& el) { return hasher(el); },
+            [&](const std::uint64_t hash) { prefetch<true>(hash); },
+            [&](const std::uint64_t hash) { insert_hash(hash); });
+    }
+
+    /**
+     * @brief Checks if the provided input is likely to be in the bloom filter.
+     * @param data Data to be searched in the bloom filter.
+     * @return A boolean value specifying whether the input was present or not.
+     */
+    template <hashable_with<Hasher> T>
+    [[nodiscard]] constexpr auto search(const T& data) const noexcept {
+        return search_hash(hasher(data));
+    }
+
+    /**
+     * @brief Checks if an element, which has already been hashed with `hasher`, is likely to be in
+     * the bloom filter.
+     * @param hash Hash of the element.
+     * @return A boolean value specifying whether the element was present or not.
+     */
+    [[nodiscard]] constexpr auto search_hash(const std::uint64_t hash) const noexcept -> bool {
+        const auto res = detail::search_words<Reducer>(bvec.data(), bits, hash_fns, hash);
+        stats.search(1, res ? 1 : 0);
+        return res;
+    }
+
+    /**
+     * @brief Prefetches the words that an element, which has already been hashed with `hasher`,
+     * maps to.
+     * @param hash Hash of the element.
+     */
+    template <bool Write = false>
+    void prefetch(const std::uint64_t hash) const noexcept {
+        const auto probes = detail::Probes{hash};
+        for (std::size_t idx = 0; idx < hash_fns; idx++) {
+            detail::prefetch<Write>(bvec.data() + Reducer::reduce(probes[idx], bits) / 64);
+        }
+    }
+
+    /**
+     * @brief Checks if the provided input is likely to be in the bloom filter, as a task which
+     * prefetches the words of the input and yields to the other coroutines of a scheduler before
+     * it reads them. The input is hashed right away and the filter must outlive the task.
+     * @param data Data to be searched in the bloom filter.
+     * @param scheduler Scheduler which interleaves the task with other coroutines.
+     * @return A task whose result specifies whether the input was present or not.
+     */
+    template <hashable_with<Hasher> T>
+    [[nodiscard]] auto async_search(const T& data, Interleaver& scheduler) const -> Task<bool> {
+        return async_search_hash(hasher(data), scheduler);
+    }
+
+    /**
+     * @brief Checks if an element, which has already been hashed with `hasher`, is likely to be in
+     * the bloom filter, as a task which prefetches its words and yields before it reads them.
+     * @param hash Hash of the element.
+     * @param scheduler Scheduler which interleaves the task with other coroutines.
+     * @return A task whose result specifies whether the element was present or not.
+     */
+    [[nodiscard]] auto async_search_hash(const std::uint64_t hash, Interleaver& scheduler) const
+        -> Task<bool> {
+        prefetch(hash);
+        co_await scheduler.yield();
+        co_return search_hash(hash);
+    }
+
+    /**
+     * @brief Checks if the provided input elements are likely to be in the bloom filter.
+     * @param data Data to be searched in the bloom filter.
+     * @return A boolean value specifying whether the input was present or not.
+     */
+    [[nodiscard]] auto search_many(iterable auto&& it) const noexcept {
+        bitvec res{};
+        std::array<std::uint8_t, detail::batch_size> found{};
+        detail::for_each_batch(hasher, it, [&](const detail::Probes* probes, const std::size_t n) {
+            detail::search_batch<Reducer>(bvec.data(), bits, hash_fns, probes, n, found.data());
+            count(found.data(), n);
+            res.insert(res.end(), found.begin(), found.begin() + n);
+        });
+        return res;
+    }
+
+    /**
+     * @brief Checks if the provided input elements are likely to be in the bloom filter. The
+     * elements are hashed in batches and the batches are searched with the widest SIMD kernel
+     * that the CPU supports (see `bf::simd`).
+     * @param it An iterable containing elements to be searched in the bloom filter.
+     * @param res Output, one byte per element which is one if the element was present and zero
+     * otherwise. It must hold at least as many bytes as there are elements.
+     */
+    void search_many(iterable auto&& it, std::span<std::uint8_t> res) const {
+        detail::for_each_batch(hasher, it, [&](const detail::Probes* probes, const std::size_t n) {
+            if (res.size() < n) {
+                throw std::length_error("Result buffer is smaller than the number of elements.");
+            }
+            detail::search_batch<Reducer>(bvec.data(), bits, hash_fns, probes, n, res.data());
+            count(res.data(), n);
+            res = res.subspan(n);
+        });
+    }
+
+    /**
+     * @brief Checks if the provided input elements are likely to be in the bloom filter. The words
+     * of every element are prefetched `window` elements ahead, which pays off for filters that are
+     * much larger than the last-level cache.
+     * @param it An iterable containing elements to be searched in the bloom filter.
+     * @param res Output, one byte per element which is one if the element was present and zero
+     * otherwise. It must hold at least as many bytes as there are elements.
+     * @param window Number of elements between the prefetch and the search of an element.
+     */
+    void search_many(iterable auto&& it, std::span<std::uint8_t> res,
+                     const std::size_t window) const {
+        std::size_t idx = 0;
+        detail::pipeline(
+            it, window, [&](const auto& el) { return hasher(el); },
+            [&](const std::uint64_t hash) { prefetch(hash); },
+            [&](const std::uint64_t hash) {
+                if (idx == res.size()) {
+                    throw std::length_error(
+                        "Result buffer is smaller than the number of elements.");
+                }
+                res[idx++] = static_cast<std::uint8_t>(search_hash(hash));
+            });
+    }
+
+    /**
+     * @brief Inserts elements from the provided range into the bloom filter in parallel. The range
+     * is split into chunks which are inserted by the threads of the executor, and the bits are set
+     * with relaxed atomic operations, so that no extra memory is needed.
+     * @param ex Executor, such as `bf::ThreadPool`.
+     * @param it A random-access range containing elements to be inserted into the bloom filter.
+     */
+    void insert_many(executor auto& ex, const std::ranges::random_access_range auto& it) {
+        const auto begin = std::ranges::begin(it);
+        ex.parallel_for(std::ranges::size(it), [&](const std::size_t lo, const std::size_t hi) {
+            for (auto el = begin + lo; el != begin + hi; ++el) {
+                detail::insert_atomic<Reducer>(bvec, bits, hash_fns, hasher(*el));
+            }
+            stats.insert(hi - lo);
+        });
+    }
+
+    /**
+     * @brief Inserts elements, which have already been hashed with `hasher`, into the bloom filter
+     * in parallel, with relaxed atomic operations as in `insert_many`.
+     * @param ex Executor, such as `bf::ThreadPool`.
+     * @param hashes Hashes of the elements.
+     */
+    void insert_hashes(executor auto& ex, const std::span<const std::uint64_t> hashes) {
+        ex.parallel_for(hashes.size(), [&](const std::size_t lo, const std::size_t hi) {
+            for (auto idx = lo; idx < hi; idx++) {
+                detail::insert_atomic<Reducer>(bvec, bits, hash_fns, hashes[idx]);
+            }
+            stats.insert(hi - lo);
+        });
+    }
+
+    /**
+     * @brief Checks if the provided input elements are likely to be in the bloom filter, in
+     * parallel. The range is split into chunks which are searched by the threads of the executor
+     * with the batched SIMD kernels, and the results are written in the order of the range.
+     * @param ex Executor, such as `bf::ThreadPool`.
+     * @param it A random-access range containing elements to be searched in the bloom filter.
+     * @param res Output, one byte per element which is one if the element was present and zero
+     * otherwise. It must hold at least as many bytes as there are elements.
+     */
+    void search_many(executor auto& ex, const std::ranges::random_access_range auto& it,
+                     std::span<std::uint8_t> res) const {
+        const auto size = static_cast<std::size_t>(std::ranges::size(it));
+        if (res.size() < size) {
+            throw std::length_error("Result buffer is smaller than the number of elements.");
+        }
+        const auto begin = std::ranges::begin(it);
+        ex.parallel_for(size, [&](const std::size_t lo, const std::size_t hi) {
+            search_many(std::ranges::subrange(begin + lo, begin + hi), res.subspan(lo, hi - lo));
+        });
+    }
+
+    /// @brief Fraction of the bits which are set.
+    [[nodiscard]] auto fill_ratio() const noexcept -> double {
+        return static_cast<double>(detail::popcount_words(bvec.data(), bvec.words())) /
+               static_cast<double>(bits);
+    }
+
+    /**
+     * @brief Estimates the number of distinct elements in the bloom filter from the number of set
+     * bits `x`, as `-m / k * ln(1 - x / m)` (Swamidass and Baldi, 2007).
+     * @return The estimated number of elements, which is infinite for a saturated filter.
+     */
+    [[nodiscard]] auto estimated_cardinality() const noexcept -> double {
+        return -static_cast<double>(bits) / static_cast<double>(hash_fns) *
+               std::log1p(-fill_ratio());
+    }
+
+    /**
+     * @brief Estimates the false positive probability of the bloom filter from its fill ratio,
+     * which can be compared with the design probability to decide when to rebuild the filter.
+     * @return The probability that all of the bits of an element which was not inserted are set.
+     */
+    [[nodiscard]] auto current_fpr_estimate() const noexcept -> double {
+        return std::pow(fill_ratio(), static_cast<double>(hash_fns));
+    }
+
+    /**
+     * @brief Clears the bloom filter in place, without reallocating the bit vector.
+     */
+    auto clear() noexcept {
+        bvec.clear();
+    }
+
+    /**
+     * @brief Clears the bloom filter in place with the threads of an executor, which pays off for
+     * filters that are much larger than the last-level cache.
+     * @param ex Executor, such as a `ThreadPool`.
+     */
+    void clear(executor auto& ex) {
+        detail::clear_parallel(bvec, ex);
+    }
+
+    /**
+     * @brief Merges another bloom filter into this one, so that this one holds the union of their
+     * elements, as if all of them had been inserted into it. Both filters must have the same
+     * parameters and hash function.
+     * @param other Bloom filter to be merged.
+     * @return This bloom filter.
+     * @throws std::invalid_argument If the parameters of the filters differ.
+     */
+    auto operator|=(const BloomFilter& other) -> BloomFilter& {
+        detail::check_combinable(bits, hash_fns, other.bits, other.hash_fns);
+        detail::combine_words<std::bit_or<>>(bvec.data(), other.bvec.data(), bvec.words());
+        return *this;
+    }
+
+    /**
+     * @brief Intersects this bloom filter with another one. The result finds every element which
+     * is in both filters; its bits are a superset of those of a filter of the intersection, so that
+     * its false positive probability can be higher than that of such a filter.
+     * @param other Bloom filter to be intersected with.
+     * @return This bloom filter.
+     * @throws std::invalid_argument If the parameters of the filters differ.
+     */
+    auto operator&=(const BloomFilter& other) -> BloomFilter& {
+        detail::check_combinable(bits, hash_fns, other.bits, other.hash_fns);
+        detail::combine_words<std::bit_and<>>(bvec.data(), other.bvec.data(), bvec.words());
+        return *this;
+    }
+
+    /**
+     * @brief Merges another bloom filter into this one, the same as `operator|=`.
+     * @param other Bloom filter to be merged.
+     */
+    void merge(const BloomFilter& other) {
+        *this |= other;
+    }
+
+    /**
+     * @brief Merges another bloom filter into this one with the threads of an executor, which pays
+     * off for filters of gigabytes.
+     * @param other Bloom filter to be merged.
+     * @param ex Executor, such as a `ThreadPool`.
+     */
+    void merge(const BloomFilter& other, executor auto& ex) {
+        detail::check_combinable(bits, hash_fns, other.bits, other.hash_fns);
+        detail::combine_parallel<std::bit_or<>>(bvec, other.bvec, ex);
+    }
+
+    /**
+     * @brief Intersects this bloom filter with another one with the threads of an executor.
+     * @param other Bloom filter to be intersected with.
+     * @param ex Executor, such as a `ThreadPool`.
+     */
+    void intersect(const BloomFilter& other, executor auto& ex) {
+        detail::check_combinable(bits, hash_fns, other.bits, other.hash_fns);
+        detail::combine_parallel<std::bit_and<>>(bvec, other.bvec, ex);
+    }
+
+    /**
+     * @brief Shrinks the bloom filter by a power of two without its elements, by or-ing every
+     * `bits / factor` bits of the bit vector into the first ones. Since a position is reduced by
+     * masking, the position of every probe in the folded filter is that in the original filter
+     * masked by the new size, so that it finds every element which was inserted. The false
+     * positive probability grows with the fill ratio of the folded filter, which `fold_factor`
+     * estimates. Only filters with the `PowerOfTwo` reduction can be folded.
+     * @param factor Factor by which the number of bits shrinks, a power of two no larger than it.
+     * @throws std::invalid_argument If the factor is not a power of two or too large.
+     */
+    void fold(const std::size_t factor)
+        requires std::same_as<Reducer, PowerOfTwo>
+    {
+        if (!std::has_single_bit(factor) || factor > bits) {
+            throw std::invalid_argument(
+                "Folding factor must be a power of two no larger than the number of bits.");
+        }
+        const auto target = bits / factor;
+        auto folded = BasicBitArray<Allocator>(target, bvec.get_allocator());
+        const auto words = std::max<std::size_t>(target / BitArray::word_bits, 1);
+        const auto old_words = std::max<std::size_t>(bits / BitArray::word_bits, 1);
+        std::copy_n(bvec.data(), words, folded.data());
+        for (auto seg = words; seg < old_words; seg += words) {
+            detail::combine_words<std::bit_or<>>(folded.data(), bvec.data() + seg, words);
+        }
+        // Filters of fewer than 64 bits are folded within their word.
+        auto& word = folded.data()[0];
+        for (auto width = std::min(bits, BitArray::word_bits); width > target; width /= 2) {
+            word = (word | (word >> (width / 2))) & ((std::uint64_t{1} << (width / 2)) - 1);
+        }
+        bits = target;
+        bvec = std::move(folded);
+    }
+
+    /**
+     * @brief Grows the bloom filter by a power of two without its elements, by repeating the bit
+     * vector `factor` times, which is the reverse of `fold`. Every element which was inserted is
+     * still found, at the same false positive probability, and elements which are inserted later
+     * fill the larger filter more slowly. Only filters with the `PowerOfTwo` reduction can be
+     * unfolded.
+     * @param factor Factor by which the number of bits grows, a power of two.
+     * @throws std::invalid_argument If the factor is not a power of two.
+     */
+    void unfold(const std::size_t factor)
+        requires std::same_as<Reducer, PowerOfTwo>
+    {
+        if (!std::has_single_bit(factor) ||
+            factor > std::numeric_limits<std::size_t>::max() / 2 / bits) {
+            throw std::invalid_argument("Unfolding factor must be a power of two.");
+        }
+        const auto target = bits * factor;
+        auto unfolded = BasicBitArray<Allocator>(target, bvec.get_allocator());
+        const auto words = std::max<std::size_t>(bits / BitArray::word_bits, 1);
+        std::copy_n(bvec.data(), words, unfolded.data());
+        // Filters of fewer than 64 bits are first repeated within their word.
+        auto& word = unfolded.data()[0];
+        for (auto width = bits; width < std::min(target, BitArray::word_bits); width *= 2) {
+            word |= word << width;
+        }
+        for (auto seg = words; seg < target / BitArray::word_bits; seg += words) {
+            std::copy_n(unfolded.data(), words, unfolded.data() + seg);
+        }
+        bits = target;
+        bvec = std::move(unfolded);
+    }
+
+    /**
+     * @brief Estimates the largest factor by which the bloom filter can be folded while keeping
+     * the estimated false positive probability within a bound. Folding by a factor raises the
+     * fraction of unset bits to the power of the factor.
+     * @param eps Bound on the false positive probability of the folded filter.
+     * @return The largest power of two to fold by, which is one if the filter cannot be folded.
+     */
+    [[nodiscard]] auto fold_factor(const arithmetic auto eps) const noexcept -> std::size_t
+        requires std::same_as<Reducer, PowerOfTwo>
+    {
+        const auto empty = 1 - fill_ratio();
+        const auto fpr = [&](const std::size_t factor) {
+            return std::pow(1 - std::pow(empty, static_cast<double>(factor)),
+                            static_cast<double>(hash_fns));
+        };
+        std::size_t res = 1;
+        while (res < bits && fpr(2 * res) <= static_cast<double>(eps)) {
+            res *= 2;
+        }
+        return res;
+    }
+
+    /**
+     * @brief Writes the bloom filter to a stream. The format is a 64-byte header with the
+     * parameters, the policies, and a checksum of the filter, followed by the words of the bit
+     * vector, which can be memory-mapped by `MappedBloomFilter`, or by their compressed code.
+     * @param os Output stream.
+     * @param compression Compression of the bit vector.
+     */
+    void save(std::ostream& os, const Compression compression = Compression::none) const {
+        auto header = detail::Header{};
+        header.layout = detail::Layout::standard;
+        header.encoding = detail::encoding_for(compression, bits, bvec.data(), bvec.words());
+        header.bits = bits;
+        header.hash_fns = hash_fns;
+        header.words = bvec.words();
+        header.hasher = detail::policy_id<Hasher>;
+        header.reducer = detail::policy_id<Reducer>;
+        header.seed = detail::hasher_seed(hasher);
+        detail::write(os, header, bvec.data());
+    }
+
+    /**
+     * @brief Reads a bloom filter, which was written by `save`, from a stream.
+     * @param is Input stream.
+     * @param hash Hash function, with the seed that the filter was saved with.
+     * @param alloc Allocator of the bit vector.
+     * @return The bloom filter.
+     */
+    [[nodiscard]] static auto load(std::istream& is, Hasher hash = {}, const Allocator& alloc = {})
+        -> BloomFilter {
+        const auto header = detail::read_header(is);
+        header.validate(detail::Layout::standard, detail::policy_id<Hasher>,
+                        detail::policy_id<Reducer>, detail::hasher_seed(hash));
+        auto res = BloomFilter{{header.bits, header.hash_fns}, hash, alloc};
+        detail::read_words(is, header, res.bvec.data());
+        return res;
+    }
+
+   private:
+    /// @brief Counts a batch of lookups, whose results are bytes.
+    void count(const std::uint8_t* found, const std::size_t n) const noexcept {
+        if constexpr (Stats::enabled) {
+            stats.search(n, static_cast<std::uint64_t>(std::count(found, found + n, 1)));
+        }
+    }
+
+    BloomFilter(const std::pair<std::size_t, std::uint64_t> params, Hasher hash,
+                const Allocator& alloc)
+        : bits{params.first}, hash_fns{params.second}, bvec(bits, alloc), hasher{hash} {}
+};
+
+/// @brief Parameters of a `StaticBloomFilter`.
+struct StaticParameters {
+    // Number of bits in the bit vector.
+    std::size_t bits;
+    // Number of hash functions.
+    std::uint64_t hash_fns;
+};
+
+/**
+ * @brief Computes the optimal parameters of a `StaticBloomFilter` at compile time, with the same
+ * formulas as the constructor of `BloomFilter`.
+ * @param elems An approximate number of elements to be inserted.
+ * @param eps False positive probability.
+ * @return The number of bits, rounded by `Reducer`, and the number of hash functions.
+ */
+template <typename Reducer = FastRange>
+[[nodiscard]] consteval auto static_parameters(const std::uint64_t elems, const double eps)
+    -> StaticParameters {
+    if (elems <= 0) {
+        throw std::domain_error("Number of elements must be greater than zero.");
+    }
+    if (eps <= 0 || eps >= 1) {
+        throw std::domain_error("False positive probability must be between zero and one.");
+    }
+
+    const auto ln2 = detail::log(2);
+    // `BloomFilter` negates the ceiling of a negative number, which truncates the number of bits.
+    const std::size_t bits = Reducer::size(
+        static_cast<std::size_t>(-static_cast<double>(elems) * detail::log(eps) / (ln2 * ln2)));
+    const std::uint64_t hash_fns =
+        detail::ceil(static_cast<double>(bits) / static_cast<double>(elems) * ln2);
+    return {bits, hash_fns};
+}
+
+/**
+ * @brief A bloom filter whose number of bits and hash functions are template parameters, so that
+ * the probe loop is unrolled and the range reduction is folded into constants. The bits are stored
+ * inline in a `std::array`, which suits small filters that are created often, and every operation
+ * is usable in constant expressions. The parameters are usually computed by `static_parameters`:
+ *
+ * ```cpp
+ * constexpr auto params = bf::static_parameters(1000, 1e-2);
+ * auto bf = bf::StaticBloomFilter<params.bits, params.hash_fns>{};
+ * ```
+ */
+template <std::size_t Bits, std::uint64_t K, typename Hasher = DefaultHasher,
+          typename Reducer = FastRange>
+struct StaticBloomFilter {
+    static_assert(Bits > 0 && Reducer::size(Bits) == Bits,
+                  "Number of bits must be non-zero and a size of the range reduction.");
+    static_assert(K > 0, "Number of hash functions must be greater than zero.");
+
+    // Number of bits in the bit vector.
+    static constexpr std::size_t bits = Bits;
+    // Number of hash functions.
+    static constexpr std::uint64_t hash_fns = K;
+    // Number of 64-bit words in the bit vector.
+    static constexpr std::size_t word_count =
+        (Bits + BitArray::word_bits - 1) / BitArray::word_bits;
+
+    // Words of the bit vector.
+    alignas(BitArray::alignment) std::array<std::uint64_t, word_count> words{};
+    // Hash function.
+    [[no_unique_address]] Hasher hasher{};
+
+    /**
+     * @brief Inserts a new element into the bloom filter.
+     * @param data Data to be inserted into a bloom filter.
+     */
+    template <hashable_with<Hasher> T>
+    constexpr void insert(const T& data) noexcept {
+        insert_hash(hasher(data));
+    }
+
+    /**
+     * @brief Inserts an element, which has already been hashed with `hasher`, into the bloom
+     * filter.
+     * @param hash Hash of the element.
+     */
+    constexpr void insert_hash(const std::uint64_t hash) noexcept {
+        const auto probes = detail::Probes{hash};
+        [&]<std::uint64_t... Idx>(std::integer_sequence<std::uint64_t, Idx...>) {
+            (set(Reducer::reduce(probes[Idx], Bits)), ...);
+        }(std::make_integer_sequence<std::uint64_t, K>{});
+    }
+
+    /**
+     * @brief Inserts elements from the provided iterable into the bloom filter.
+     * @param it An iterable containing elements to be inserted into the bloom filter.
+     */
+    constexpr void insert_many(iterable auto&& it) noexcept {
+        for (const auto& el : it) {
+            insert(el);
+        }
+    }
+
+    /**
+     * @brief Checks if the provided input is likely to be in the bloom filter.
+     * @param data Data to be searched in the bloom filter.
+     * @return A boolean value specifying whether the input was present or not.
+     */
+    template <hashable_with<Hasher> T>
+    [[nodiscard]] constexpr auto search(const T& data) const noexcept {
+        return search_hash(hasher(data));
+    }
+
+    /**
+     * @brief Checks if an element, which has already been hashed with `hasher`, is likely to be in
+     * the bloom filter.
+     * @param hash Hash of the element.
+     * @return A boolean value specifying whether the element was present or not.
+     */
+    [[nodiscard]] constexpr auto search_hash(const std::uint64_t hash) const noexcept -> bool {
+        const auto probes = detail::Probes{hash};
+        return [&]<std::uint64_t... Idx>(std::integer_sequence<std::uint64_t, Idx...>) {
+            return (test(Reducer::reduce(probes[Idx], Bits)) && ...);
+        }(std::make_integer_sequence<std::uint64_t, K>{});
+    }
+
+    /**
+     * @brief Checks if the provided input elements are likely to be in the bloom filter.
+     * @param data Data to be searched in the bloom filter.
+     * @return A boolean value specifying whether the input was present or not.
+     */
+    [[nodiscard]] constexpr auto search_many(iterable auto&& it) const noexcept {
+        bitvec res{};
+        for (const auto& el : it) {
+            res.push_back(search(el));
+        }
+        return res;
+    }
+
+    /**
+     * @brief Clears the bloom filter.
+     */
+    constexpr void clear() noexcept {
+        words.fill(0);
+    }
+
+   private:
+    constexpr void set(const std::size_t pos) noexcept {
+        words[pos / BitArray::word_bits] |= std::uint64_t{1} << (pos % BitArray::word_bits);
+    }
+
+    [[nodiscard]] constexpr auto test(const std::size_t pos) const noexcept -> bool {
+        return ((words[pos / BitArray::word_bits] >> (pos % BitArray::word_bits)) & 1) != 0;
+    }
+};
+
+namespace pmr {
+
+// An allocator of cache-line-aligned storage from a `std::pmr::memory_resource`.
+template <typename T>
+using AlignedAllocator =
+    bf::AlignedAllocator<T, BitArray::alignment, std::pmr::polymorphic_allocator<std::byte>>;
+
+/**
+ * @brief A bloom filter whose bit vector is allocated from a `std::pmr::memory_resource`, such as
+ * a `std::pmr::monotonic_buffer_resource` of a request, and is still aligned to cache lines.
+ *
+ * ```cpp
+ * auto arena = std::pmr::monotonic_buffer_resource{};
+ * auto bf = bf::pmr::BloomFilter<>{1000, 1e-2, {}, &arena};
+ * ```
+ */
+template <typename Hasher = DefaultHasher, typename Reducer = FastRange>
+using BloomFilter = bf::BloomFilter<Hasher, Reducer, AlignedAllocator<std::uint64_t>>;
+
+}  // namespace pmr
+
+/**
+ * @brief A counting bloom filter, which supports deletions by replacing every bit of a
+ * `BloomFilter` with a 4-bit saturating counter. The counters are packed sixteen to a 64-bit
+ * word, so that a counter is updated by adding or subtracting a shifted one within its word.
+ * The probes and the false positive probability are those of `BloomFilter` with the same
+ * parameters. A counter which reaches 15 saturates and is never decremented again, which keeps
+ * deletions from introducing false negatives.
+ */
+template <typename Hasher = DefaultHasher, typename Reducer = FastRange>
+struct CountingBloomFilter {
+    // Number of bits in a counter.
+    static constexpr std::size_t counter_bits = 4;
+    // Number of counters in a word.
+    static constexpr std::size_t word_counters = 64 / counter_bits;
+    // Largest value of a counter, at which the counter saturates.
+    static constexpr std::uint64_t max_count = (std::uint64_t{1} << counter_bits) - 1;
+
+    // Number of counters.
+    std::size_t counters;
+    // Number of hash functions.
+    std::uint64_t hash_fns;
+    // Words of the counters.
+    std::vector<std::uint64_t, AlignedAllocator<std::uint64_t>> words;
+    // Hash function.
+    [[no_unique_address]] Hasher hasher;
+
+    /**
+     * @brief Creates a new counting bloom filter with optimal parameters.
+     * @param n An approximate number of elements to be inserted.
+     * @param eps False positive probability.
+     * @param hash Hash function.
+     */
+    explicit CountingBloomFilter(const std::uint64_t elems, const arithmetic auto eps,
+                                 Hasher hash = {})
+        : hasher{hash} {
+        std::tie(counters, hash_fns) = detail::optimal_parameters<Reducer>(elems, eps);
+        words.assign((counters + word_counters - 1) / word_counters, 0);
+    }
+
+    /**
+     * @brief Inserts a new element into the bloom filter.
+     * @param data Data to be inserted into a bloom filter.
+     */
+    template <hashable_with<Hasher> T>
+    void insert(const T& data) noexcept {
+        insert_hash(hasher(data));
+    }
+
+    /**
+     * @brief Inserts an element, which has already been hashed with `hasher`, into the bloom
+     * filter.
+     * @param hash Hash of the element.
+     */
+    void insert_hash(const std::uint64_t hash) noexcept {
+        const auto probes = detail::Probes{hash};
+        for (std::size_t idx = 0; idx < hash_fns; idx++) {
+            const auto pos = Reducer::reduce(probes[idx], counters);
+            auto& word = words[pos / word_counters];
+            const auto shift = pos % word_counters * counter_bits;
+            if (((word >> shift) & max_count) != max_count) {
+                word += std::uint64_t{1} << shift;
+            }
+        }
+    }
+
+    /**
+     * @brief Inserts elements from the provided iterable into the bloom filter.
+     * @param it An iterable containing elements to be inserted into the bloom filter.
+     */
+    void insert_many(iterable auto&& it) noexcept {
+        for (const auto& el : it) {
+            insert(el);
+        }
+    }
+
+    /**
+     * @brief Removes an element from the bloom filter. Only elements which were inserted should be
+     * removed; an element which is not present is left alone, but a false positive is removed
+     * like an inserted element, at the cost of false negatives for the elements it collides with.
+     * @param data Data to be removed from the bloom filter.
+     * @return A boolean value specifying whether the element was present and removed.
+     */
+    template <hashable_with<Hasher> T>
+    auto erase(const T& data) noexcept -> bool {
+        return erase_hash(hasher(data));
+    }
+
+    /**
+     * @brief Removes an element, which has already been hashed with `hasher`, from the bloom
+     * filter.
+     * @param hash Hash of the element.
+     * @return A boolean value specifying whether the element was present and removed.
+     */
+    auto erase_hash(const std::uint64_t hash) noexcept -> bool {
+        if (!search_hash(hash)) {
+            return false;
+        }
+        const auto probes = detail::Probes{hash};
+        for (std::size_t idx = 0; idx < hash_fns; idx++) {
+            const auto pos = Reducer::reduce(probes[idx], counters);
+            auto& word = words[pos / word_counters];
+            const auto shift = pos % word_counters * counter_bits;
+            const auto count = (word >> shift) & max_count;
+            // A probe which repeats an earlier one of the element may already be zero.
+            if (count != 0 && count != max_count) {
+                word -= std::uint64_t{1} << shift;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Checks if the provided input is likely to be in the bloom filter.
+     * @param data Data to be searched in the bloom filter.
+     * @return A boolean value specifying whether the input was present or not.
+     */
+    template <hashable_with<Hasher> T>
+    [[nodiscard]] auto search(const T& data) const noexcept {
+        return search_hash(hasher(data));
+    }
+
+    /**
+     * @brief Checks if an element, which has already been hashed with `hasher`, is likely to be in
+     * the bloom filter.
+     * @param hash Hash of the element.
+     * @return A boolean value specifying whether the element was present or not.
+     */
+    [[nodiscard]] auto search_hash(const std::uint64_t hash) const noexcept -> bool {
+        return count_hash(hash) != 0;
+    }
+
+    /**
+     * @brief Checks if the provided input elements are likely to be in the bloom filter.
+     * @param data Data to be searched in the bloom filter.
+     * @return A boolean value specifying whether the input was present or not.
+     */
+    [[nodiscard]] auto search_many(iterable auto&& it) const noexcept {
+        bitvec res{};
+        for (const auto& el : it) {
+            res.push_back(search(el));
+        }
+        return res;
+    }
+
+    /**
+     * @brief Estimates how many times an element was inserted, as the smallest of its counters.
+     * The estimate never undercounts an element which was inserted fewer than 15 times and not
+     * removed, and is at most 15.
+     * @param data Data to be counted.
+     * @return The estimated number of insertions of the element.
+     */
+    template <hashable_with<Hasher> T>
+    [[nodiscard]] auto count_estimate(const T& data) const noexcept -> std::uint64_t {
+        return count_hash(hasher(data));
+    }
+
+    /**
+     * @brief Clears the bloom filter in place.
+     */
+    void clear() noexcept {
+        std::ranges::fill(words, 0);
+    }
+
+   private:
+    /// @brief Smallest counter of a hashed element.
+    [[nodiscard]] auto count_hash(const std::uint64_t hash) const noexcept -> std::uint64_t {
+        const auto probes = detail::Probes{hash};
+        auto res = max_count;
+        for (std::size_t idx = 0; idx < hash_fns && res != 0; idx++) {
+            const auto pos = Reducer::reduce(probes[idx], counters);
+            const auto shift = pos % word_counters * counter_bits;
+            res = std::min(res, (words[pos / word_counters] >> shift) & max_count);
+        }
+        return res;
+    }
+};
+
+/**
+ * @brief A scalable bloom filter (Almeida, Baquero, Preguiça, and Hutchison, 2007), which grows
+ * with the number of inserted elements instead of requiring it up front. The filter is a chain of
+ * `BloomFilter` layers: every layer holds `growth` times as many elements as the previous one at
+ * `tightening` times its false positive probability, so that the false positive probability of the
+ * whole chain stays below `eps`. Only the newest layer is inserted into and a new layer is added
+ * when it is full, which never rehashes the elements of the older layers. Lookups probe the newest
+ * and largest layer first.
+ */
+template <typename Hasher = DefaultHasher, typename Reducer = FastRange>
+struct ScalableBloomFilter {
+    using layer_type = BloomFilter<Hasher, Reducer>;
+
+    // Ratio of the capacities of consecutive layers.
+    static constexpr std::uint64_t growth = 2;
+    // Ratio of the false positive probabilities of consecutive layers.
+    static constexpr double tightening = 0.9;
+
+    /**
+     * @brief Creates a new scalable bloom filter with a single, small layer.
+     * @param initial Number of elements of the first layer.
+     * @param eps Bound of the false positive probability of the whole filter.
+     * @param hash Hash function.
+     */
+    explicit ScalableBloomFilter(const std::uint64_t initial, const arithmetic auto eps,
+                                 Hasher hash = {})
+        : initial_{initial}, eps_{static_cast<double>(eps)}, hasher_{hash} {
+        if (eps <= 0 || eps >= 1) {
+            throw std::domain_error("False positive probability must be between zero and one.");
+        }
+        grow();
+    }
+
+    /**
+     * @brief Inserts a new element into the bloom filter.
+     * @param data Data to be inserted into a bloom filter.
+     */
+    template <hashable_with<Hasher> T>
+    void insert(const T& data) {
+        insert_hash(hasher_(data));
+    }
+
+    /**
+     * @brief Inserts an element, which has already been hashed with `hasher`, into the newest
+     * layer, after adding a layer if the newest one is full.
+     * @param hash Hash of the element.
+     */
+    void insert_hash(const std::uint64_t hash) {
+        if (fill_ == capacity(layers_.size() - 1)) {
+            grow();
+        }
+        layers_.back().insert_hash(hash);
+        fill_++;
+        size_++;
+    }
+
+    /**
+     * @brief Inserts elements from the provided iterable into the bloom filter.
+     * @param it An iterable containing elements to be inserted into the bloom filter.
+     */
+    void insert_many(iterable auto&& it) {
+        for (const auto& el : it) {
+            insert(el);
+        }
+    }
+
+    /**
+     * @brief Checks if the provided input is likely to be in the bloom filter.
+     * @param data Data to be searched in the bloom filter.
+     * @return A boolean value specifying whether the input was present or not.
+     */
+    template <hashable_with<Hasher> T>
+    [[nodiscard]] auto search(const T& data) const noexcept {
+        return search_hash(hasher_(data));
+    }
+
+    /**
+     * @brief Checks if an element, which has already been hashed with `hasher`, is likely to be in
+     * any of the layers, from the newest to the oldest.
+     * @param hash Hash of the element.
+     * @return A boolean value specifying whether the element was present or not.
+     */
+    [[nodiscard]] auto search_hash(const std::uint64_t hash) const noexcept -> bool {
+        return std::any_of(layers_.rbegin(), layers_.rend(),
+                           [&](const auto& layer) { return layer.search_hash(hash); });
+    }
+
+    /**
+     * @brief Checks if the provided input elements are likely to be in the bloom filter.
+     * @param data Data to be searched in the bloom filter.
+     * @return A boolean value specifying whether the input was present or not.
+     */
+    [[nodiscard]] auto search_many(iterable auto&& it) const noexcept {
+        bitvec res{};
+        for (const auto& el : it) {
+            res.push_back(search(el));
+        }
+        return res;
+    }
+
+    /**
+     * @brief Clears the bloom filter and shrinks it back to its first layer.
+     */
+    void clear() {
+        layers_.erase(layers_.begin() + 1, layers_.end());
+        layers_.front().clear();
+        fill_ = 0;
+        size_ = 0;
+    }
+
+    /// @brief Layers of the filter, from the oldest to the newest.
+    [[nodiscard]] auto layers() const noexcept -> std::span<const layer_type> {
+        return layers_;
+    }
+
+    /// @brief Number of inserted elements.
+    [[nodiscard]] auto size() const noexcept -> std::uint64_t {
+        return size_;
+    }
+
+    /**
+     * @brief Computes the bound of the false positive probability of the layers so far, which is
+     * below the `eps` of the constructor however many layers are added.
+     * @return The sum of the false positive probabilities of the layers.
+     */
+    [[nodiscard]] auto fpr() const noexcept -> double {
+        auto res = 0.0;
+        for (std::size_t idx = 0; idx < layers_.size(); idx++) {
+            res += layer_eps(idx);
+        }
+        return res;
+    }
+
+    /// @brief Hash function.
+    [[nodiscard]] auto hasher() const noexcept -> const Hasher& {
+        return hasher_;
+    }
+
+   private:
+    /// @brief Number of elements of a layer.
+    [[nodiscard]] auto capacity(const std::size_t idx) const noexcept -> std::uint64_t {
+        return initial_ << (idx * std::countr_zero(growth));
+    }
+
+    /// @brief False positive probability of a layer, whose geometric series sums to `eps`.
+    [[nodiscard]] auto layer_eps(const std::size_t idx) const noexcept -> double {
+        return eps_ * (1 - tightening) * std::pow(tightening, static_cast<double>(idx));
+    }
+
+    void grow() {
+        layers_.emplace_back(capacity(layers_.size()), layer_eps(layers_.size()), hasher_);
+        fill_ = 0;
+    }
+
+    std::uint64_t initial_;
+    double eps_;
+    [[no_unique_address]] Hasher hasher_;
+    std::vector<layer_type> layers_;
+    // Number of elements in the newest layer.
+    std::uint64_t fill_{};
+    std::uint64_t size_{};
+};
+
+namespace numa {
+
+/**
+ * @brief Lists the CPUs of a NUMA node, as read from `/sys/devices/system/node`.
+ * @param node Index of the node.
+ * @return The indices of the CPUs of the node, which are empty if the node is unknown.
+ */
+[[nodiscard]] inline auto node_cpus(const std::size_t node) -> std::vector<int> {
+    std::vector<int> res;
+#if defined(BF_HAS_NUMA)
+    auto file = std::ifstream{"/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"};
+    // The list is a comma-separated list of ranges, such as `0-3,8-11`.
+    std::string range;
+    while (std::getline(file, range, ',')) {
+        const auto dash = range.find('-');
+        const auto first = std::stoi(range.substr(0, dash));
+        const auto last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for (auto cpu = first; cpu <= last; cpu++) {
+            res.push_back(cpu);
+        }
+    }
+#else
+    static_cast<void>(node);
+#endif
+    return res;
+}
+
+/// @brief Number of NUMA nodes of the system, which is one if the system does not report them.
+[[nodiscard]] inline auto node_count() -> std::size_t {
+    std::size_t res = 0;
+    while (!node_cpus(res).empty()) {
+        res++;
+    }
+    return std::max<std::size_t>(res, 1);
+}
+
+/**
+ * @brief Pins the calling thread to the CPUs of a NUMA node, so that the memory which it touches
+ * first is allocated on that node and later accesses from it are local.
+ * @param node Index of the node.
+ * @return Whether the thread was pinned, which fails if the node is unknown or on systems without
+ * thread affinity.
+ */
+inline auto pin_to_node(const std::size_t node) -> bool {
+#if defined(BF_HAS_NUMA)
+    const auto cpus = node_cpus(node);
+    if (cpus.empty()) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const auto cpu : cpus) {
+        CPU_SET(cpu, &set);
+    }
+    return ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set) == 0;
+#else
+    static_cast<void>(node);
+    return false;
+#endif
+}
+
+}  // namespace numa
+
+/**
+ * @brief A bloom filter which is partitioned into shards, each of which is a `BloomFilter` of its
+ * own placed on a NUMA node. The high bits of the hash of an element select its shard, and the
+ * shards are spread over the nodes round-robin. Every shard is allocated and zeroed by a thread
+ * pinned to its node, so that the first-touch policy of the kernel places its pages there, and
+ * threads which own a shard can pin themselves to its node with `pin_to_shard`. Since the shards
+ * are independent, every shard can be inserted into, merged, or saved by its own thread without
+ * synchronization.
+ */
+template <typename Hasher = DefaultHasher, typename Reducer = FastRange>
+struct PartitionedBloomFilter {
+    using shard_type = BloomFilter<Hasher, Reducer>;
+
+    /**
+     * @brief Creates a new partitioned bloom filter with optimal parameters.
+     * @param n An approximate number of elements to be inserted.
+     * @param eps False positive probability.
+     * @param shards Number of shards, by default one per NUMA node.
+     * @param hash Hash function.
+     */
+    explicit PartitionedBloomFilter(const std::uint64_t elems, const arithmetic auto eps,
+                                    const std::size_t shards = numa::node_count(),
+                                    Hasher hash = {})
+        : nodes_{numa::node_count()}, hasher_{hash} {
+        if (elems <= 0 || shards <= 0) {
+            throw std::domain_error("Number of elements and shards must be greater than zero.");
+        }
+        const auto shard_elems = (elems + shards - 1) / shards;
+        std::vector<std::optional<shard_type>> slots(shards);
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::vector<std::thread> threads;
+        for (std::size_t idx = 0; idx < shards; idx++) {
+            threads.emplace_back([&, idx] {
+                try {
+                    numa::pin_to_node(node_of(idx));
+                    slots[idx].emplace(shard_elems, eps, hash);
+                } catch (...) {
+                    const auto lock = std::lock_guard{mutex};
+                    error = std::current_exception();
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        shards_.reserve(shards);
+        for (auto& slot : slots) {
+            shards_.push_back(std::move(*slot));
+        }
+    }
+
+    /**
+     * @brief Inserts a new element into the bloom filter.
+     * @param data Data to be inserted into a bloom filter.
+     */
+    template <hashable_with<Hasher> T>
+    void insert(const T& data) noexcept {
+        insert_hash(hasher_(data));
+    }
+
+    /**
+     * @brief Inserts an element, which has already been hashed with `hasher`, into its shard.
+     * @param hash Hash of the element.
+     */
+    void insert_hash(const std::uint64_t hash) noexcept {
+        shards_[shard_of(hash)].insert_hash(shard_hash(hash));
+    }
+
+    /**
+     * @brief Inserts elements from the provided iterable into the bloom filter.
+     * @param it An iterable containing elements to be inserted into the bloom filter.
+     */
+    void insert_many(iterable auto&& it) noexcept {
+        for (const auto& el : it) {
+            insert(el);
+        }
+    }
+
+    /**
+     * @brief Checks if the provided input is likely to be in the bloom filter.
+     * @param data Data to be searched in the bloom filter.
+     * @return A boolean value specifying whether the input was present or not.
+     */
+    template <hashable_with<Hasher> T>
+    [[nodiscard]] auto search(const T& data) const noexcept {
+        return search_hash(hasher_(data));
+    }
+
+    /**
+     * @brief Checks if an element, which has already been hashed with `hasher`, is likely to be in
+     * its shard.
+     * @param hash Hash of the element.
+     * @return A boolean value specifying whether the element was present or not.
+     */
+    [[nodiscard]] auto search_hash(const std::uint64_t hash) const noexcept -> bool {
+        return shards_[shard_of(hash)].search_hash(shard_hash(hash));
+    }
+
+    /**
+     * @brief Checks if the provided input elements are likely to be in the bloom filter.
+     * @param data Data to be searched in the bloom filter.
+     * @return A boolean value specifying whether the input was present or not.
+     */
+    [[nodiscard]] auto search_many(iterable auto&& it) const noexcept {
+        bitvec res{};
+        for (const auto& el : it) {
+            res.push_back(search(el));
+        }
+        return res;
+    }
+
+    /**
+     * @brief Clears every shard in place.
+     */
+    void clear() noexcept {
+        for (auto& shard : shards_) {
+            shard.clear();
+        }
+    }
+
+    /// @brief Index of the shard that a hash maps to, selected by the high bits of the hash.
+    [[nodiscard]] auto shard_of(const std::uint64_t hash) const noexcept -> std::size_t {
+        return FastRange::reduce(hash, shards_.size());
+    }
+
+    /// @brief NUMA node of a shard.
+    [[nodiscard]] auto node_of(const std::size_t shard) const noexcept -> std::size_t {
+        return shard % nodes_;
+    }
+
+    /**
+     * @brief Pins the calling thread to the NUMA node of a shard.
+     * @param shard Index of the shard.
+     * @return Whether the thread was pinned.
+     */
+    auto pin_to_shard(const std::size_t shard) const -> bool {
+        return numa::pin_to_node(node_of(shard));
+    }
+
+    /// @brief Shards of the filter, which are inserted into with hashes mixed by `shard_hash`.
+    [[nodiscard]] auto shards() noexcept -> std::span<shard_type> {
+        return shards_;
+    }
+
+    [[nodiscard]] auto shards() const noexcept -> std::span<const shard_type> {
+        return shards_;
+    }
+
+    /**
+     * @brief Mixes the hash of an element into the hash which its shard is probed with. The high
+     * bits of the hash have selected the shard, and probing the shard with them again would
+     * confine the first probe of its elements to a fraction of the shard.
+     * @param hash Hash of the element.
+     * @return The hash of the element in its shard.
+     */
+    [[nodiscard]] static constexpr auto shard_hash(const std::uint64_t hash) noexcept
+        -> std::uint64_t {
+        return detail::mix64(hash);
+    }
+
+    /// @brief Hash function.
+    [[nodiscard]] auto hasher() const noexcept -> const Hasher& {
+        return hasher_;
+    }
+
+   private:
+    std::size_t nodes_;
+    [[no_unique_address]] Hasher hasher_;
+    std::vector<shard_type> shards_;
+};
+
+/**
+ * @brief A cache-line-blocked bloom filter. The first hash selects a 64-byte block and all of the
+ * bits of an element are set and tested inside of that block, so that every lookup touches a
+ * single cache line. Blocking makes the load of the individual blocks uneven, which increases the
+ * false positive rate; the constructor accounts for that by adding blocks until the expected false
+ * positive probability of the blocked layout is within the requested bound.
+ */
+template <typename Hasher = DefaultHasher, typename Reducer = FastRange>
+struct BlockedBloomFilter {
+    // Number of bits in a block (a 64-byte cache line).
+    static constexpr std::size_t block_bits = 512;
+    // Shift that maps a 64-bit hash value onto a bit of a block.
+    static constexpr int block_shift = 64 - std::countr_zero(block_bits);
+    // Maximum number of hash functions.
+    static constexpr std::uint64_t max_hash_fns = 64;
+    // Odd multipliers, one per hash function, which map the second hash of an element onto the
+    // bits of its block. Unlike double hashing, whose probes repeat quickly within the 512 bits of
+    // a block, the multiply-shift probes are close to independent.
+    static constexpr std::array<std::uint64_t, max_hash_fns> salts = [] {
+        std::array<std::uint64_t, max_hash_fns> res{};
+        for (std::uint64_t idx = 0; idx < max_hash_fns; idx++) {
+            res[idx] = detail::mix64(0x9e3779b97f4a7c15ULL * (idx + 1)) | 1;
+        }
+        return res;
+    }();
+
+    // Number of blocks in the bit vector.
+    std::size_t blocks;
+    // Number of bits in the bit vector.
+    std::size_t bits;
+    // Number of hash functions.
+    std::uint64_t hash_fns;
+    // Bit vector.
+    BitArray bvec;
+    // Hash function.
+    [[no_unique_address]] Hasher hasher;
+
+    /**
+     * @brief Creates a new blocked bloom filter with optimal parameters.
+     * @param n An approximate number of elements to be inserted.
+     * @param eps False positive probability.
+     * @param hash Hash function.
+     */
+    explicit BlockedBloomFilter(const std::uint64_t elems, const arithmetic auto eps,
+                                Hasher hash = {})
+        : BlockedBloomFilter{parameters(elems, eps), hash} {}
+
+    /**
+     * @brief Creates a new, empty blocked bloom filter of a given size, such as one computed by
+     * `parameters`.
+     * @param params Number of blocks and number of hash functions.
+     * @param hash Hash function.
+     */
+    explicit BlockedBloomFilter(const std::pair<std::size_t, std::uint64_t> params,
+                                Hasher hash = {})
+        : blocks{params.first},
+          bits{blocks * block_bits},
+          hash_fns{params.second},
+          bvec(bits),
+          hasher{hash} {}
+
+    /**
+     * @brief Computes the size of a blocked bloom filter with optimal parameters.
+     * @param n An approximate number of elements to be inserted.
+     * @param eps False positive probability.
+     * @return The number of blocks and the number of hash functions.
+     */
+    [[nodiscard]] static auto parameters(const std::uint64_t elems, const arithmetic auto eps)
+        -> std::pair<std::size_t, std::uint64_t> {
+        if (elems <= 0) {
+            throw std::domain_error("Number of elements must be greater than zero.");
+        }
+        if (eps <= 0 || eps >= 1) {
+            throw std::domain_error("False positive probability must be between zero and one.");
+        }
+
+        const auto unblocked = -std::ceil(elems * std::log(eps) / std::pow(std::log(2), 2));
+        const auto hash_fns = std::min<std::uint64_t>(
+            max_hash_fns, std::ceil(unblocked / static_cast<double>(elems) * std::log(2)));
+        auto blocks = std::max<std::size_t>(1, std::ceil(unblocked / block_bits));
+        while (fpr(elems, blocks, hash_fns) > eps) {
+            blocks += std::max<std::size_t>(1, blocks / 64);
+        }
+        return {Reducer::size(blocks), hash_fns};
+    }
+
+    /**
+     * @brief Computes the expected false positive probability of a blocked bloom filter. The
+     * number of elements that land in a block is Poisson distributed, and every block is a
+     * standard bloom filter of `block_bits` bits (Putze, Sanders, and Singler, 2007).
+     * @param elems Number of inserted elements.
+     * @param blocks Number of blocks.
+     * @param hash_fns Number of hash functions.
+     * @return The expected false positive probability.
+     */
+    [[nodiscard]] static auto fpr(const std::uint64_t elems, const std::size_t blocks,
+                                  const std::uint64_t hash_fns) noexcept -> double {
+        const auto lambda = static_cast<double>(elems) / static_cast<double>(blocks);
+        const auto upper = static_cast<std::uint64_t>(lambda + 10 * std::sqrt(lambda) + 10);
+        const auto miss = std::log1p(-1.0 / block_bits);
+        auto res = 0.0;
+        for (std::uint64_t i = 0; i <= upper; i++) {
+            const auto load = static_cast<double>(i);
+            const auto poisson = std::exp(load * std::log(lambda) - lambda - std::lgamma(load + 1));
+            const auto fill = -std::expm1(static_cast<double>(hash_fns) * load * miss);
+            res += poisson * std::pow(fill, static_cast<double>(hash_fns));
+        }
+        return res;
+    }
+
+    /**
+     * @brief Inserts a new element into the bloom filter.
+     * @param data Data to be inserted into a bloom filter.
+     */
+    template <hashable_with<Hasher> T>
+    void insert(const T& data) noexcept {
+        insert_hash(hasher(data));
+    }
+
+    /**
+     * @brief Inserts an element, which has already been hashed with `hasher`, into the bloom
+     * filter.
+     * @param hash Hash of the element.
+     */
+    void insert_hash(const std::uint64_t hash) noexcept {
+        const auto probes = detail::Probes{hash};
+        const auto base = block(probes);
+        for (std::size_t idx = 0; idx < hash_fns; idx++) {
+            bvec.set(base + ((probes.h2 * salts[idx]) >> block_shift));
+        }
+    }
+
+    /**
+     * @brief Inserts elements from the provided iterable into the bloom filter.
+     * @param it An iterable containing elements to be inserted into the bloom filter.
+     */
+    void insert_many(iterable auto&& it) noexcept {
+        for (const auto& el : it) {
+            insert(el);
+        }
+    }
+
+    /**
+     * @brief Inserts elements from the provided iterable into the bloom filter. The block of every
+     * element is prefetched `window` elements ahead, which pays off for filters that are much
+     * larger than the last-level cache.
+     * @param it An iterable containing elements to be inserted into the bloom filter.
+     * @param window Number of elements between the prefetch and the insertion of an element.
+     */
+    void insert_many(iterable auto&& it, const std::size_t window) {
+        detail::pipeline(
+            it, window, [&](const auto& el) { return hasher(el); },
+            [&](const std::uint64_t hash) { prefetch<true>(hash); },
+            [&](const std::uint64_t hash) { insert_hash(hash); });
+    }
+
+    /**
+     * @brief Checks if the provided input is likely to be in the bloom filter.
+     * @param data Data to be searched in the bloom filter.
+     * @return A boolean value specifying whether the input was present or not.
+     */
+    template <hashable_with<Hasher> T>
+    [[nodiscard]] auto search(const T& data) const noexcept {
+        return search_hash(hasher(data));
+    }
+
+    /**
+     * @brief Checks if an element, which has already been hashed with `hasher`, is likely to be in
+     * the bloom filter.
+     * @param hash Hash of the element.
+     * @return A boolean value specifying whether the element was present or not.
+     */
+    [[nodiscard]] auto search_hash(const std::uint64_t hash) const noexcept -> bool {
+        return search_words(bvec.data(), blocks, hash_fns, hash);
+    }
+
+    /**
+     * @brief Checks if an element, which has already been hashed, is likely to be in the words of
+     * a blocked bloom filter, such as a memory-mapped one.
+     * @param words Words of the bit vector.
+     * @param blocks Number of blocks.
+     * @param hash_fns Number of hash functions.
+     * @param hash Hash of the element.
+     * @return A boolean value specifying whether the element was present or not.
+     */
+    [[nodiscard]] static auto search_words(const std::uint64_t* words, const std::size_t blocks,
+                                           const std::uint64_t hash_fns,
+                                           const std::uint64_t hash) noexcept -> bool {
+        const auto probes = detail::Probes{hash};
+        const auto base = Reducer::reduce(probes.h1, blocks) * block_bits;
+        for (std::size_t idx = 0; idx < hash_fns; idx++) {
+            const auto bit = base + ((probes.h2 * salts[idx]) >> block_shift);
+            if (((words[bit / BitArray::word_bits] >> (bit % BitArray::word_bits)) & 1) == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Prefetches the block that an element, which has already been hashed with `hasher`,
+     * maps to.
+     * @param hash Hash of the element.
+     */
+    template <bool Write = false>
+    void prefetch(const std::uint64_t hash) const noexcept {
+        detail::prefetch<Write>(bvec.data() + block(detail::Probes{hash}) / 64);
+    }
+
+    /**
+     * @brief Checks if the provided input is likely to be in the bloom filter, as a task which
+     * prefetches the words of the input and yields to the other coroutines of a scheduler before
+     * it reads them. The input is hashed right away and the filter must outlive the task.
+     * @param data Data to be searched in the bloom filter.
+     * @param scheduler Scheduler which interleaves the task with other coroutines.
+     * @return A task whose result specifies whether the input was present or not.
+     */
+    template <hashable_with<Hasher> T>
+    [[nodiscard]] auto async_search(const T& data, Interleaver& scheduler) const -> Task<bool> {
+        return async_search_hash(hasher(data), scheduler);
+    }
+
+    /**
+     * @brief Checks if an element, which has already been hashed with `hasher`, is likely to be in
+     * the bloom filter, as a task which prefetches its words and yields before it reads them.
+     * @param hash Hash of the element.
+     * @param scheduler Scheduler which interleaves the task with other coroutines.
+     * @return A task whose result specifies whether the element was present or not.
+     */
+    [[nodiscard]] auto async_search_hash(const std::uint64_t hash, Interleaver& scheduler) const
+        -> Task<bool> {
+        prefetch(hash);
+        co_await scheduler.yield();
+        co_return search_hash(hash);
+    }
+
+    /**
+     * @brief Checks if the provided input elements are likely to be in the bloom filter.
+     * @param data Data to be searched in the bloom filter.
+     * @return A boolean value specifying whether the input was present or not.
+     */
+    [[nodiscard]] auto search_many(iterable auto&& it) const noexcept {
+        bitvec res{};
+        for (const auto& el : it) {
+            res.push_back(search(el));
+        }
+        return res;
+    }
+
+    /**
+     * @brief Checks if the provided input elements are likely to be in the bloom filter. The block
+     * of every element is prefetched `window` elements ahead, which pays off for filters that are
+     * much larger than the last-level cache.
+     * @param it An iterable containing elements to be searched in the bloom filter.
+     * @param res Output, one byte per element which is one if the element was present and zero
+     * otherwise. It must hold at least as many bytes as there are elements.
+     * @param window Number of elements between the prefetch and the search of an element.
+     */
+    void search_many(iterable auto&& it, std::span<std::uint8_t> res,
+                     const std::size_t window = prefetch_window) const {
+        std::size_t idx = 0;
+        detail::pipeline(
+            it, window, [&](const auto& el) { return hasher(el); },
+            [&](const std::uint64_t hash) { prefetch(hash); },
+            [&](const std::uint64_t hash) {
+                if (idx == res.size()) {
+                    throw std::length_error(
+                        "Result buffer is smaller than the number of elements.");
+                }
+                res[idx++] = static_cast<std::uint8_t>(search_hash(hash));
+            });
+    }
+
+    /**
+     * @brief Clears the bloom filter in place, without reallocating the bit vector.
+     */
+    auto clear() noexcept {
+        bvec.clear();
+    }
+
+    /**
+     * @brief Clears the bloom filter in place with the threads of an executor.
+     * @param ex Executor, such as a `ThreadPool`.
+     */
+    void clear(executor auto& ex) {
+        detail::clear_parallel(bvec, ex);
+    }
+
+    /**
+     * @brief Merges another bloom filter into this one, so that this one holds the union of their
+     * elements, as if all of them had been inserted into it. Both filters must have the same
+     * parameters and hash function.
+     * @param other Bloom filter to be merged.
+     * @return This bloom filter.
+     * @throws std::invalid_argument If the parameters of the filters differ.
+     */
+    auto operator|=(const BlockedBloomFilter& other) -> BlockedBloomFilter& {
+        detail::check_combinable(bits, hash_fns, other.bits, other.hash_fns);
+        detail::combine_words<std::bit_or<>>(bvec.data(), other.bvec.data(), bvec.words());
+        return *this;
+    }
+
+    /**
+     * @brief Intersects this bloom filter with another one. The result finds every element which
+     * is in both filters; its bits are a superset of those of a filter of the intersection, so that
+     * its false positive probability can be higher than that of such a filter.
+     * @param other Bloom filter to be intersected with.
+     * @return This bloom filter.
+     * @throws std::invalid_argument If the parameters of the filters differ.
+     */
+    auto operator&=(const BlockedBloomFilter& other) -> BlockedBloomFilter& {
+        detail::check_combinable(bits, hash_fns, other.bits, other.hash_fns);
+        detail::combine_words<std::bit_and<>>(bvec.data(), other.bvec.data(), bvec.words());
+        return *this;
+    }
+
+    /**
+     * @brief Merges another bloom filter into this one, the same as `operator|=`.
+     * @param other Bloom filter to be merged.
+     */
+    void merge(const BlockedBloomFilter& other) {
+        *this |= other;
+    }
+
+    /**
+     * @brief Merges another bloom filter into this one with the threads of an executor, which pays
+     * off for filters of gigabytes.
+     * @param other Bloom filter to be merged.
+     * @param ex Executor, such as a `ThreadPool`.
+     */
+    void merge(const BlockedBloomFilter& other, executor auto& ex) {
+        detail::check_combinable(bits, hash_fns, other.bits, other.hash_fns);
+        detail::combine_parallel<std::bit_or<>>(bvec, other.bvec, ex);
+    }
+
+    /**
+     * @brief Intersects this bloom filter with another one with the threads of an executor.
+     * @param other Bloom filter to be intersected with.
+     * @param ex Executor, such as a `ThreadPool`.
+     */
+    void intersect(const BlockedBloomFilter& other, executor auto& ex) {
+        detail::check_combinable(bits, hash_fns, other.bits, other.hash_fns);
+        detail::combine_parallel<std::bit_and<>>(bvec, other.bvec, ex);
+    }
+
+    /**
+     * @brief Writes the bloom filter to a stream, in the format of `BloomFilter::save` with the
+     * blocked layout, which can be memory-mapped by `MappedBlockedBloomFilter`.
+     * @param os Output stream.
+     * @param compression Compression of the bit vector.
+     */
+    void save(std::ostream& os, const Compression compression = Compression::none) const {
+        auto header = detail::Header{};
+        header.layout = detail::Layout::blocked;
+        header.encoding = detail::encoding_for(compression, bits, bvec.data(), bvec.words());
+        header.bits = bits;
+        header.hash_fns = hash_fns;
+        header.words = bvec.words();
+        header.hasher = detail::policy_id<Hasher>;
+        header.reducer = detail::policy_id<Reducer>;
+        header.seed = detail::hasher_seed(hasher);
+        detail::write(os, header, bvec.data());
+    }
+
+    /**
+     * @brief Reads a blocked bloom filter, which was written by `save`, from a stream.
+     * @param is Input stream.
+     * @param hash Hash function, with the seed that the filter was saved with.
+     * @return The bloom filter.
+     */
+    [[nodiscard]] static auto load(std::istream& is, Hasher hash = {}) -> BlockedBloomFilter {
+        const auto header = detail::read_header(is);
+        header.validate(detail::Layout::blocked, detail::policy_id<Hasher>,
+                        detail::policy_id<Reducer>, detail::hasher_seed(hash));
+        auto res = BlockedBloomFilter{{header.bits / block_bits, header.hash_fns}, hash};
+        detail::read_words(is, header, res.bvec.data());
+        return res;
+    }
+
+   private:
+    // The layout of serialized filters, which `detail::Header` checks.
+    static_assert(block_bits == 512 && max_hash_fns == 64);
+
+    /// @brief Position of the first bit of the block that the probes map to.
+    [[nodiscard]] auto block(const detail::Probes& probes) const noexcept -> std::size_t {
+        return Reducer::reduce(probes.h1, blocks) * block_bits;
+    }
+};
+
+/**
+ * @brief A register-blocked bloom filter, which keeps all of the bits of an element in a single
+ * 64-bit word, for small filters that fit in the L1 cache. A lookup is a load, an and, and a
+ * compare against the mask of the element, which is the union of two patterns from a precomputed
+ * table: one with half of the bits in the even positions of the word and one with the other half
+ * in the odd positions, so that every mask has exactly `hash_fns` bits. The false positive
+ * probability is higher than that of a `BlockedBloomFilter` with the same number of bits, which
+ * the constructor makes up for with more bits.
+ */
+template <typename Hasher = DefaultHasher, typename Reducer = FastRange>
+struct RegisterBlockedBloomFilter {
+    // Number of bits in a block (a 64-bit word).
+    static constexpr std::size_t block_bits = 64;
+    // Maximum number of hash functions.
+    static constexpr std::uint64_t max_hash_fns = 16;
+    // Number of patterns of each half of a mask.
+    static constexpr std::size_t pattern_count = 512;
+    // Number of bits of the hash which select the two patterns of a mask.
+    static constexpr int pattern_bits = 2 * std::countr_zero(pattern_count);
+    // Patterns for every number of hash functions: the first `pattern_count` of a row have
+    // `(hash_fns + 1) / 2` distinct even bits and the others `hash_fns / 2` distinct odd bits.
+    static constexpr auto patterns = [] {
+        std::array<std::array<std::uint64_t, 2 * pattern_count>, max_hash_fns + 1> res{};
+        std::uint64_t state = 0;
+        for (std::uint64_t fns = 1; fns <= max_hash_fns; fns++) {
+            for (std::size_t idx = 0; idx < 2 * pattern_count; idx++) {
+                const auto odd = static_cast<std::uint64_t>(idx >= pattern_count);
+                const auto bits = odd == 0 ? (fns + 1) / 2 : fns / 2;
+                auto& pattern = res[fns][idx];
+                while (static_cast<std::uint64_t>(std::popcount(pattern)) < bits) {
+                    state += 0x9e3779b97f4a7c15ULL;
+                    pattern |= std::uint64_t{1} << (2 * (detail::mix64(state) >> 59) + odd);
+                }
+            }
+        }
+        return res;
+    }();
+
+    // Number of blocks in the bit vector.
+    std::size_t blocks;
+    // Number of bits in the bit vector.
+    std::size_t bits;
+    // Number of hash functions.
+    std::uint64_t hash_fns;
+    // Bit vector.
+    BitArray bvec;
+    // Hash function.
+    [[no_unique_address]] Hasher hasher;
+
+    /**
+     * @brief Creates a new register-blocked bloom filter with optimal parameters.
+     * @param n An approximate number of elements to be inserted.
+     * @param eps False positive probability.
+     * @param hash Hash function.
+     */
+    explicit RegisterBlockedBloomFilter(const std::uint64_t elems, const arithmetic auto eps,
+                                        Hasher hash = {})
+        : hasher{hash} {
+        if (elems <= 0) {
+            throw std::domain_error("Number of elements must be greater than zero.");
+        }
+        if (eps <= 0 || eps >= 1) {
+            throw std::domain_error("False positive probability must be between zero and one.");
+        }
+
+        // The optimal number of hash functions of a block is lower than that of a standard
+        // filter, so every number of hash functions is tried for every number of blocks.
+        const auto unblocked = -std::ceil(elems * std::log(eps) / std::pow(std::log(2), 2));
+        blocks = std::max<std::size_t>(1, std::ceil(unblocked / block_bits));
+        while (true) {
+            hash_fns = 1;
+            for (std::uint64_t fns = 2; fns <= max_hash_fns; fns++) {
+                if (fpr(elems, blocks, fns) < fpr(elems, blocks, hash_fns)) {
+                    hash_fns = fns;
+                }
+            }
+            if (fpr(elems, blocks, hash_fns) <= eps) {
+                break;
+            }
+            blocks += std::max<std::size_t>(1, blocks / 64);
+        }
+        blocks = Reducer::size(blocks);
+        bits = blocks * block_bits;
+        bvec = BitArray(bits);
+        patterns_ = patterns[hash_fns].data();
+    }
+
+    /**
+     * @brief Computes the expected false positive probability of a register-blocked bloom filter.
+     * The number of elements that land in a block is Poisson distributed, and the even and the odd
+     * half of every block are standard bloom filters of 32 bits. Since there are only
+     * `pattern_count` patterns per half, a half of a lookup is also found when an element of its
+     * block has the same pattern.
+     * @param elems Number of inserted elements.
+     * @param blocks Number of blocks.
+     * @param hash_fns Number of hash functions.
+     * @return The expected false positive probability.
+     */
+    [[nodiscard]] static auto fpr(const std::uint64_t elems, const std::size_t blocks,
+                                  const std::uint64_t hash_fns) noexcept -> double {
+        const auto lambda = static_cast<double>(elems) / static_cast<double>(blocks);
+        const auto upper = static_cast<std::uint64_t>(lambda + 10 * std::sqrt(lambda) + 10);
+        const auto miss = std::log1p(-2.0 / block_bits);
+        const auto other = std::log1p(-1.0 / pattern_count);
+        auto res = 0.0;
+        for (std::uint64_t i = 0; i <= upper; i++) {
+            const auto load = static_cast<double>(i);
+            const auto poisson = std::exp(load * std::log(lambda) - lambda - std::lgamma(load + 1));
+            const auto shared = -std::expm1(load * other);
+            const auto half = [&](const std::uint64_t fns) {
+                const auto count = static_cast<double>(fns);
+                const auto fill = -std::expm1(count * load * miss);
+                return shared + (1 - shared) * std::pow(fill, count);
+            };
+            res += poisson * half((hash_fns + 1) / 2) * (hash_fns > 1 ? half(hash_fns / 2) : 1.0);
+        }
+        return res;
+    }
+
+    /**
+     * @brief Inserts a new element into the bloom filter.
+     * @param data Data to be inserted into a bloom filter.
+     */
+    template <hashable_with<Hasher> T>
+    void insert(const T& data) noexcept {
+        insert_hash(hasher(data));
+    }
+
+    /**
+     * @brief Inserts an element, which has already been hashed with `hasher`, into the bloom
+     * filter.
+     * @param hash Hash of the element.
+     */
+    void insert_hash(const std::uint64_t hash) noexcept {
+        bvec.data()[block(hash)] |= mask(hash);
+    }
+
+    /**
+     * @brief Inserts elements from the provided iterable into the bloom filter.
+     * @param it An iterable containing elements to be inserted into the bloom filter.
+     */
+    void insert_many(iterable auto&& it) noexcept {
+        for (const auto& el : it) {
+            insert(el);
+        }
+    }
+
+    /**
+     * @brief Checks if the provided input is likely to be in the bloom filter.
+     * @param data Data to be searched in the bloom filter.
+     * @return A boolean value specifying whether the input was present or not.
+     */
+    template <hashable_with<Hasher> T>
+    [[nodiscard]] auto search(const T& data) const noexcept {
+        return search_hash(hasher(data));
+    }
+
+    /**
+     * @brief Checks if an element, which has already been hashed with `hasher`, is likely to be in
+     * the bloom filter.
+     * @param hash Hash of the element.
+     * @return A boolean value specifying whether the element was present or not.
+     */
+    [[nodiscard]] auto search_hash(const std::uint64_t hash) const noexcept -> bool {
+        const auto probe = mask(hash);
+        return (bvec.data()[block(hash)] & probe) == probe;
+    }
+
+    /**
+     * @brief Checks if the provided input elements are likely to be in the bloom filter.
+     * @param data Data to be searched in the bloom filter.
+     * @return A boolean value specifying whether the input was present or not.
+     */
+    [[nodiscard]] auto search_many(iterable auto&& it) const noexcept {
+        bitvec res{};
+        for (const auto& el : it) {
+            res.push_back(search(el));
+        }
+        return res;
+    }
+
+    /**
+     * @brief Clears the bloom filter in place, without reallocating the bit vector.
+     */
+    void clear() noexcept {
+        bvec.clear();
+    }
+
+   private:
+    /// @brief Index of the word that a hash maps to.
+    [[nodiscard]] auto block(const std::uint64_t hash) const noexcept -> std::size_t {
+        return Reducer::reduce(hash, blocks);
+    }
+
+    /**
+     * @brief Mask of the bits of a hash in its word. The patterns are selected by the bits of the
+     * hash which the reduction does not use for the word, whatever the size of the filter: the
+     * high bits with `PowerOfTwo`, which uses the low ones, the low bits with `FastRange`, which
+     * uses the high ones, and a remix of the hash with any other reduction.
+     */
+    [[nodiscard]] auto mask(const std::uint64_t hash) const noexcept -> std::uint64_t {
+        const auto select = [&] {
+            if constexpr (std::same_as<Reducer, PowerOfTwo>) {
+                return hash >> (64 - pattern_bits);
+            } else if constexpr (std::same_as<Reducer, FastRange>) {
+                return hash;
+            } else {
+                return detail::mix64(hash);
+            }
+        }();
+        return patterns_[select % pattern_count] |
+               patterns_[pattern_count + (select / pattern_count) % pattern_count];
+    }
+
+    // Row of `patterns` for the number of hash functions.
+    const std::uint64_t* patterns_{};
+};
+
+/**
+ * @brief A blocked bloom filter which is cleared in constant time. Every block is tagged with the
+ * epoch in which it was last written and `clear` only starts a new epoch; a block of an older epoch
+ * reads as empty and is zeroed when it is next inserted into. This suits filters that are rotated
+ * often, such as one filter per second, where an eager clear would zero all of the memory of the
+ * filter on every rotation. The layout and the false positive probability are those of
+ * `BlockedBloomFilter`, at the cost of four bytes per 64-byte block.
+ */
+template <typename Hasher = DefaultHasher, typename Reducer = FastRange>
+struct EpochBloomFilter {
+    using filter_type = BlockedBloomFilter<Hasher, Reducer>;
+
+    // Underlying blocked filter, whose blocks are only valid in the current epoch.
+    filter_type filter;
+
+    /**
+     * @brief Creates a new epoch bloom filter with optimal parameters.
+     * @param n An approximate number of elements to be inserted.
+     * @param eps False positive probability.
+     * @param hash Hash function.
+     */
+    explicit EpochBloomFilter(const std::uint64_t elems, const arithmetic auto eps,
+                              Hasher hash = {})
+        : filter{elems, eps, hash}, epochs_(filter.blocks, 0) {}
+
+    /**
+     * @brief Inserts a new element into the bloom filter.
+     * @param data Data to be inserted into a bloom filter.
+     */
+    template <hashable_with<Hasher> T>
+    void insert(const T& data) noexcept {
+        insert_hash(filter.hasher(data));
+    }
+
+    /**
+     * @brief Inserts an element, which has already been hashed with `hasher`, into the bloom
+     * filter. The block of the element is zeroed first if it was written in an older epoch.
+     * @param hash Hash of the element.
+     */
+    void insert_hash(const std::uint64_t hash) noexcept {
+        const auto idx = block(hash);
+        if (epochs_[idx] != epoch_) {
+            epochs_[idx] = epoch_;
+            std::memset(filter.bvec.data() + idx * BitArray::line_words, 0, BitArray::alignment);
+        }
+        filter.insert_hash(hash);
+    }
+
+    /**
+     * @brief Inserts elements from the provided iterable into the bloom filter.
+     * @param it An iterable containing elements to be inserted into the bloom filter.
+     */
+    void insert_many(iterable auto&& it) noexcept {
+        for (const auto& el : it) {
+            insert(el);
+        }
+    }
+
+    /**
+     * @brief Checks if the provided input is likely to be in the bloom filter.
+     * @param data Data to be searched in the bloom filter.
+     * @return A boolean value specifying whether the input was present or not.
+     */
+    template <hashable_with<Hasher> T>
+    [[nodiscard]] auto search(const T& data) const noexcept {
+        return search_hash(filter.hasher(data));
+    }
+
+    /**
+     * @brief Checks if an element, which has already been hashed with `hasher`, is likely to be in
+     * the bloom filter.
+     * @param hash Hash of the element.
+     * @return A boolean value specifying whether the element was present or not.
+     */
+    [[nodiscard]] auto search_hash(const std::uint64_t hash) const noexcept -> bool {
+        return epochs_[block(hash)] == epoch_ && filter.search_hash(hash);
+    }
+
+    /**
+     * @brief Checks if the provided input elements are likely to be in the bloom filter.
+     * @param data Data to be searched in the bloom filter.
+     * @return A boolean value specifying whether the input was present or not.
+     */
+    [[nodiscard]] auto search_many(iterable auto&& it) const noexcept {
+        bitvec res{};
+        for (const auto& el : it) {
+            res.push_back(search(el));
+        }
+        return res;
+    }
+
+    /**
+     * @brief Clears the bloom filter in constant time by starting a new epoch. Once every 2^32
+     * clears, the epochs wrap around and the filter is cleared eagerly.
+     */
+    void clear() noexcept {
+        if (++epoch_ == 0) {
+            filter.clear();
+            std::ranges::fill(epochs_, 0);
+        }
+    }
+
+    /// @brief Current epoch, which is the number of clears modulo 2^32.
+    [[nodiscard]] auto epoch() const noexcept -> std::uint32_t {
+        return epoch_;
+    }
+
+   private:
+    /// @brief Index of the block that a hash maps to.
+    [[nodiscard]] auto block(const std::uint64_t hash) const noexcept -> std::size_t {
+        return Reducer::reduce(detail::Probes{hash}.h1, filter.blocks);
+    }
+
+    std::vector<std::uint32_t> epochs_;
+    std::uint32_t epoch_{};
+};
+
+/**
+ * @brief A sliding-window bloom filter, which only remembers the elements inserted during the last
+ * `generations` generations. Every cell of the filter holds one bit per generation, for a ring of
+ * `generations + 1` generation slots, so that one lookup checks every generation in a single pass
+ * over its cells: the bits of its cells are and-ed together with the mask of the live generations.
+ * A generation ends once it holds its share of `elems` elements, or when `rotate` is called, for
+ * example from a timer to remember the elements of the last `T` minutes. The slot of the expired
+ * generation leaves the live mask at once and is scrubbed a few words per insertion while the next
+ * generation fills up, so that expiry costs amortized constant time and never stalls the stream.
+ */
+template <typename Hasher = DefaultHasher, typename Reducer = FastRange>
+struct SlidingBloomFilter {
+    // Largest number of live generations, for at most eight generation slots per cell.
+    static constexpr std::size_t max_generations = 7;
+
+    // Number of cells, each of which holds `generations + 1` bits.
+    std::size_t cells;
+    // Number of hash functions.
+    std::uint64_t hash_fns;
+    // Cells, packed into words of `64 / cell_bits` cells.
+    std::vector<std::uint64_t> words;
+    // Hash function.
+    [[no_unique_address]] Hasher hasher;
+
+    /**
+     * @brief Creates a new sliding-window bloom filter with optimal parameters. Every generation
+     * is sized for its share of the elements at its share of the false positive probability, so
+     * that the false positive probability of the whole window stays below `eps`.
+     * @param n An approximate number of elements in a window.
+     * @param eps False positive probability.
+     * @param generations Number of generations in a window, from 1 to `max_generations`.
+     * @param hash Hash function.
+     */
+    explicit SlidingBloomFilter(const std::uint64_t elems, const arithmetic auto eps,
+                                const std::size_t generations = 3, Hasher hash = {})
+        : hasher{hash}, generations_{generations} {
+        if (elems <= 0 || generations <= 0 || generations > max_generations) {
+            throw std::domain_error(
+                "Number of elements must be greater than zero and number of generations must be "
+                "between one and seven.");
+        }
+        capacity_ = (elems + generations - 1) / generations;
+        std::tie(cells, hash_fns) = detail::optimal_parameters<Reducer>(
+            capacity_, static_cast<double>(eps) / static_cast<double>(generations));
+        cell_shift_ = std::bit_width(std::bit_ceil(generations + 1) - 1);
+        const auto word_cells = BitArray::word_bits >> cell_shift_;
+        words.assign((cells + word_cells - 1) / word_cells, 0);
+        // The scrubbing of a slot is spread over the insertions of one generation.
+        scrub_words_ = (words.size() + capacity_ - 1) / capacity_;
+        for (std::size_t bit = 0; bit < BitArray::word_bits; bit += cell_bits()) {
+            lanes_ |= std::uint64_t{1} << bit;
+        }
+    }
+
+    /**
+     * @brief Inserts a new element into the current generation.
+     * @param data Data to be inserted into a bloom filter.
+     */
+    template <hashable_with<Hasher> T>
+    void insert(const T& data) noexcept {
+        insert_hash(hasher(data));
+    }
+
+    /**
+     * @brief Inserts an element, which has already been hashed with `hasher`, into the current
+     * generation, which ends once it is full.
+     * @param hash Hash of the element.
+     */
+    void insert_hash(const std::uint64_t hash) noexcept {
+        if (inserted_ == capacity_) {
+            rotate();
+        }
+        scrub(scrub_words_);
+        const auto probes = detail::Probes{hash};
+        for (std::size_t idx = 0; idx < hash_fns; idx++) {
+            const auto cell = Reducer::reduce(probes[idx], cells);
+            words[cell >> word_shift()] |= std::uint64_t{1} << (shift(cell) + current_);
+        }
+        inserted_++;
+    }
+
+    /**
+     * @brief Inserts elements from the provided iterable into the bloom filter.
+     * @param it An iterable containing elements to be inserted into the bloom filter.
+     */
+    void insert_many(iterable auto&& it) noexcept {
+        for (const auto& el : it) {
+            insert(el);
+        }
+    }
+
+    /**
+     * @brief Checks if the provided input is likely to have been inserted in one of the live
+     * generations.
+     * @param data Data to be searched in the bloom filter.
+     * @return A boolean value specifying whether the input was present or not.
+     */
+    template <hashable_with<Hasher> T>
+    [[nodiscard]] auto search(const T& data) const noexcept {
+        return search_hash(hasher(data));
+    }
+
+    /**
+     * @brief Checks if an element, which has already been hashed with `hasher`, is likely to have
+     * been inserted in one of the live generations.
+     * @param hash Hash of the element.
+     * @return A boolean value specifying whether the element was present or not.
+     */
+    [[nodiscard]] auto search_hash(const std::uint64_t hash) const noexcept -> bool {
+        const auto probes = detail::Probes{hash};
+        auto live = live_mask();
+        for (std::size_t idx = 0; idx < hash_fns && live != 0; idx++) {
+            const auto cell = Reducer::reduce(probes[idx], cells);
+            live &= words[cell >> word_shift()] >> shift(cell);
+        }
+        return live != 0;
+    }
+
+    /**
+     * @brief Checks if the provided input elements are likely to be in the bloom filter.
+     * @param data Data to be searched in the bloom filter.
+     * @return A boolean value specifying whether the input was present or not.
+     */
+    [[nodiscard]] auto search_many(iterable auto&& it) const noexcept {
+        bitvec res{};
+        for (const auto& el : it) {
+            res.push_back(search(el));
+        }
+        return res;
+    }
+
+    /**
+     * @brief Ends the current generation, which expires the oldest live one. The slot of the new
+     * generation is the one which was scrubbed during the current generation, and what is left of
+     * its scrubbing is finished first, which only costs time when generations are ended before
+     * they are full.
+     */
+    void rotate() noexcept {
+        scrub(words.size());
+        current_ = next();
+        inserted_ = 0;
+        scrubbed_ = 0;
+    }
+
+    /**
+     * @brief Clears every generation in place.
+     */
+    void clear() noexcept {
+        std::ranges::fill(words, 0);
+        inserted_ = 0;
+        scrubbed_ = words.size();
+    }
+
+    /// @brief Number of live generations.
+    [[nodiscard]] auto generations() const noexcept -> std::size_t {
+        return generations_;
+    }
+
+    /// @brief Number of elements which a generation holds before it ends.
+    [[nodiscard]] auto capacity() const noexcept -> std::size_t {
+        return capacity_;
+    }
+
+   private:
+    /// @brief Number of bits of a cell, which is the number of generation slots rounded up to a
+    /// power of two.
+    [[nodiscard]] auto cell_bits() const noexcept -> std::size_t {
+        return std::size_t{1} << cell_shift_;
+    }
+
+    /// @brief Base two logarithm of the number of cells per word.
+    [[nodiscard]] auto word_shift() const noexcept -> std::size_t {
+        return std::countr_zero(BitArray::word_bits) - cell_shift_;
+    }
+
+    /// @brief Position of the first bit of a cell in its word.
+    [[nodiscard]] auto shift(const std::size_t cell) const noexcept -> std::size_t {
+        return (cell << cell_shift_) % BitArray::word_bits;
+    }
+
+    /// @brief Slot which follows the current one, which is the one being scrubbed.
+    [[nodiscard]] auto next() const noexcept -> std::size_t {
+        return current_ == generations_ ? 0 : current_ + 1;
+    }
+
+    /// @brief Mask of the slots of the live generations, which are all but the scrubbed one.
+    [[nodiscard]] auto live_mask() const noexcept -> std::uint64_t {
+        return ((std::uint64_t{1} << (generations_ + 1)) - 1) & ~(std::uint64_t{1} << next());
+    }
+
+    /// @brief Clears the bits of the scrubbed slot in up to `count` more words.
+    void scrub(const std::size_t count) noexcept {
+        const auto end = std::min(words.size(), scrubbed_ + count);
+        const auto mask = ~(lanes_ << next());
+        for (; scrubbed_ < end; scrubbed_++) {
+            words[scrubbed_] &= mask;
+        }
+    }
+
+    std::size_t generations_;
+    std::size_t capacity_{};
+    std::size_t cell_shift_{};
+    std::size_t scrub_words_{};
+    // Word with the lowest bit of every cell set.
+    std::uint64_t lanes_{};
+    std::size_t current_{};
+    std::size_t inserted_{};
+    std::size_t scrubbed_{};
+};
+
+/**
+ * @brief A split-block bloom filter, as specified by Apache Parquet and used by Impala and Kudu.
+ * The filter is an array of 256-bit blocks of eight 32-bit words; the upper half of the hash of an
+ * element selects a block and the lower half, multiplied by eight salts, selects one bit in every
+ * word of the block. With the default `XXHash64` hasher, the bytes of the filter are those of a
+ * Parquet bloom filter bitset, so that bitsets can be read from and written to Parquet files as is.
+ */
+template <typename Hasher = XXHash64>
+struct SplitBlockBloomFilter {
+    // Number of 32-bit words in a block.
+    static constexpr std::size_t block_words = 8;
+    // Number of bytes in a block.
+    static constexpr std::size_t block_bytes = block_words * sizeof(std::uint32_t);
+    // Salts which select the bit in every word of a block.
+    static constexpr std::array<std::uint32_t, block_words> salts = {
+        0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+        0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+    // Number of blocks.
+    std::size_t blocks;
+    // Words of the blocks.
+    std::vector<std::uint32_t, AlignedAllocator<std::uint32_t, block_bytes>> words;
+    // Hash function.
+    [[no_unique_address]] Hasher hasher;
+
+    /**
+     * @brief Creates a new split-block bloom filter. The number of bytes is computed as in the
+     * Parquet implementations and rounded up to a power of two, of at least one block.
+     * @param n An approximate number of elements to be inserted.
+     * @param eps False positive probability.
+     * @param hash Hash function.
+     */
+    explicit SplitBlockBloomFilter(const std::uint64_t elems, const arithmetic auto eps,
+                                   Hasher hash = {})
+        : blocks{blocks_for(elems, eps)}, words(blocks * block_words), hasher{hash} {}
+
+    /**
+     * @brief Computes the number of blocks of a split-block bloom filter, as the constructor does.
+     * @param n An approximate number of elements to be inserted.
+     * @param eps False positive probability.
+     * @return The number of blocks.
+     */
+    [[nodiscard]] static auto blocks_for(const std::uint64_t elems, const arithmetic auto eps)
+        -> std::size_t {
+        if (elems <= 0) {
+            throw std::domain_error("Number of elements must be greater than zero.");
+        }
+        if (eps <= 0 || eps >= 1) {
+            throw std::domain_error("False positive probability must be between zero and one.");
+        }
+
+        const auto bits = -8.0 * static_cast<double>(elems) / std::log1p(-std::pow(eps, 1.0 / 8));
+        const auto bytes = std::bit_ceil(
+            std::max<std::size_t>(block_bytes, static_cast<std::size_t>(std::ceil(bits / 8))));
+        return bytes / block_bytes;
+    }
+
+    /**
+     * @brief Creates a split-block bloom filter from a bitset, such as one read from a Parquet
+     * file.
+     * @param bitset Bytes of the filter, whose size must be a non-zero multiple of 32.
+     * @param hash Hash function.
+     */
+    explicit SplitBlockBloomFilter(const std::span<const std::byte> bitset, Hasher hash = {})
+        : blocks{bitset.size() / block_bytes}, words(blocks * block_words), hasher{hash} {
+        if (bitset.empty() || bitset.size() % block_bytes != 0) {
+            throw std::invalid_argument("Size of the bitset must be a multiple of 32 bytes.");
+        }
+        std::memcpy(words.data(), bitset.data(), bitset.size());
+    }
+
+    /// @brief Bytes of the filter, in the layout of a Parquet bloom filter bitset.
+    [[nodiscard]] auto bytes() const noexcept -> std::span<const std::byte> {
+        static_assert(std::endian::native == std::endian::little,
+                      "The bitset layout is only supported on little-endian targets.");
+        return std::as_bytes(std::span{words});
+    }
+
+    /**
+     * @brief Inserts a new element into the bloom filter.
+     * @param data Data to be inserted into a bloom filter.
+     */
+    template <hashable_with<Hasher> T>
+    void insert(const T& data) noexcept {
+        insert_hash(hasher(data));
+    }
+
+    /**
+     * @brief Inserts an element, which has already been hashed with `hasher`, into the bloom
+     * filter.
+     * @param hash Hash of the element.
+     */
+    void insert_hash(const std::uint64_t hash) noexcept {
+        auto* block = words.data() + index(hash, blocks) * block_words;
+        const auto key = static_cast<std::uint32_t>(hash);
+#if defined(BF_HAS_X86_SIMD)
+        if (simd() != Simd::scalar) {
+            return detail::split_block_insert_avx2(block, key, salts.data());
+        }
+#endif
+        for (std::size_t idx = 0; idx < block_words; idx++) {
+            block[idx] |= std::uint32_t{1} << ((key * salts[idx]) >> 27);
+        }
+    }
+
+    /**
+     * @brief Inserts elements from the provided iterable into the bloom filter.
+     * @param it An iterable containing elements to be inserted into the bloom filter.
+     */
+    void insert_many(iterable auto&& it) noexcept {
+        for (const auto& el : it) {
+            insert(el);
+        }
+    }
+
+    /**
+     * @brief Checks if the provided input is likely to be in the bloom filter.
+     * @param data Data to be searched in the bloom filter.
+     * @return A boolean value specifying whether the input was present or not.
+     */
+    template <hashable_with<Hasher> T>
+    [[nodiscard]] auto search(const T& data) const noexcept {
+        return search_hash(hasher(data));
+    }
+
+    /**
+     * @brief Checks if an element, which has already been hashed with `hasher`, is likely to be in
+     * the bloom filter.
+     * @param hash Hash of the element.
+     * @return A boolean value specifying whether the element was present or not.
+     */
+    [[nodiscard]] auto search_hash(const std::uint64_t hash) const noexcept -> bool {
+        return search_words(words.data(), blocks, hash);
+    }
+
+    /**
+     * @brief Computes the index of the block that an element maps to.
+     * @param hash Hash of the element.
+     * @param blocks Number of blocks.
+     * @return The index of the block.
+     */
+    [[nodiscard]] static constexpr auto index(const std::uint64_t hash,
+                                              const std::size_t blocks) noexcept -> std::size_t {
+        return static_cast<std::size_t>(((hash >> 32) * blocks) >> 32);
+    }
+
+    /**
+     * @brief Checks if an element, which has already been hashed, is likely to be in the words of
+     * a split-block bloom filter, such as a memory-mapped one.
+     * @param data Words of the blocks, aligned to a block.
+     * @param blocks Number of blocks.
+     * @param hash Hash of the element.
+     * @return A boolean value specifying whether the element was present or not.
+     */
+    [[nodiscard]] static auto search_words(const std::uint32_t* data, const std::size_t blocks,
+                                           const std::uint64_t hash) noexcept -> bool {
+        const auto* block = data + index(hash, blocks) * block_words;
+        const auto key = static_cast<std::uint32_t>(hash);
+#if defined(BF_HAS_X86_SIMD)
+        if (simd() != Simd::scalar) {
+            return detail::split_block_check_avx2(block, key, salts.data());
+        }
+#endif
+        std::uint32_t miss = 0;
+        for (std::size_t idx = 0; idx < block_words; idx++) {
+            miss |= ~block[idx] & (std::uint32_t{1} << ((key * salts[idx]) >> 27));
+        }
+        return miss == 0;
+    }
+
+    /**
+     * @brief Checks if the provided input elements are likely to be in the bloom filter.
+     * @param data Data to be searched in the bloom filter.
+     * @return A boolean value specifying whether the input was present or not.
+     */
+    [[nodiscard]] auto search_many(iterable auto&& it) const noexcept {
+        bitvec res{};
+        for (const auto& el : it) {
+            res.push_back(search(el));
+        }
+        return res;
+    }
+
+    /**
+     * @brief Clears the bloom filter.
+     */
+    auto clear() noexcept {
+        std::ranges::fill(words, 0);
+    }
+
+    /**
+     * @brief Writes the bloom filter to a stream, in the format of `BloomFilter::save` with the
+     * split-block layout, which can be memory-mapped by `MappedSplitBlockBloomFilter`. The words
+     * after the header are the bytes of the filter.
+     * @param os Output stream.
+     * @param compression Compression of the bit vector.
+     */
+    void save(std::ostream& os, const Compression compression = Compression::none) const {
+        const auto bitset = bytes();
+        std::vector<std::uint64_t> packed(bitset.size() / sizeof(std::uint64_t));
+        std::memcpy(packed.data(), bitset.data(), bitset.size());
+        auto header = detail::Header{};
+        header.layout = detail::Layout::split_block;
+        header.bits = bitset.size() * 8;
+        header.encoding = detail::encoding_for(compression, header.bits, packed.data(),
+                                               packed.size());
+        header.hash_fns = block_words;
+        header.words = packed.size();
+        header.hasher = detail::policy_id<Hasher>;
+        header.seed = detail::hasher_seed(hasher);
+        detail::write(os, header, packed.data());
+    }
+
+    /**
+     * @brief Reads a split-block bloom filter, which was written by `save`, from a stream.
+     * @param is Input stream.
+     * @param hash Hash function, with the seed that the filter was saved with.
+     * @return The bloom filter.
+     */
+    [[nodiscard]] static auto load(std::istream& is, Hasher hash = {}) -> SplitBlockBloomFilter {
+        const auto header = detail::read_header(is);
+        header.validate(detail::Layout::split_block, detail::policy_id<Hasher>, 0,
+                        detail::hasher_seed(hash));
+        std::vector<std::uint64_t> packed(header.words);
+        detail::read_words(is, header, packed.data());
+        return SplitBlockBloomFilter{std::as_bytes(std::span{packed}), hash};
+    }
+
+   private:
+    // The layout of serialized filters, which `detail::Header` checks.
+    static_assert(block_bytes * 8 == 256 && block_words == 8);
+};
+
+/**
+ * @brief A binary fuse filter (Graf and Lemire, 2022), which represents an immutable set in about
+ * 1.13 fingerprints of `Fingerprint` per element, for sets of a million elements or more, and
+ * answers a lookup with three memory accesses.
+ * With 8-bit fingerprints, the false positive probability is 1/256 at about 9 bits per element,
+ * against 12 bits and 8 probes for a `BloomFilter`. The filter is built in bulk from all of its
+ * elements, and building it again is the only way to change it.
+ */
+template <std::unsigned_integral Fingerprint = std::uint8_t, typename Hasher = DefaultHasher>
+struct BinaryFuseFilter {
+    // Number of fingerprints that an element maps to.
+    static constexpr std::uint32_t arity = 3;
+    // Largest length of a segment.
+    static constexpr std::size_t max_segment_length = std::size_t{1} << 18;
+    // Number of seeds to try before the construction gives up.
+    static constexpr int max_iterations = 100;
+
+    // Length of a segment, a power of two.
+    std::size_t segment_length;
+    // Number of segments that the first fingerprint of an element can fall into.
+    std::size_t segment_count;
+    // Seed which mixes the hashes of the elements.
+    std::uint64_t seed{};
+    // Fingerprints.
+    std::vector<Fingerprint> fingerprints;
+    // Hash function.
+    [[no_unique_address]] Hasher hasher;
+
+    /**
+     * @brief Builds a binary fuse filter of the provided elements. Duplicate elements are allowed.
+     * @param it An iterable containing the elements of the filter.
+     * @param hash Hash function.
+     */
+    explicit BinaryFuseFilter(const iterable auto& it, Hasher hash = {}) : hasher{hash} {
+        std::vector<std::uint64_t> hashes;
+        for (const auto& el : it) {
+            hashes.push_back(hasher(el));
+        }
+        std::ranges::sort(hashes);
+        hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+        build(hashes);
+    }
+
+    /**
+     * @brief Checks if the provided input is likely to be in the filter.
+     * @param data Data to be searched in the filter.
+     * @return A boolean value specifying whether the input was present or not.
+     */
+    template <hashable_with<Hasher> T>
+    [[nodiscard]] auto search(const T& data) const noexcept {
+        return search_hash(hasher(data));
+    }
+
+    /**
+     * @brief Checks if an element, which has already been hashed with `hasher`, is likely to be in
+     * the filter.
+     * @param hash Hash of the element.
+     * @return A boolean value specifying whether the element was present or not.
+     */
+    [[nodiscard]] auto search_hash(const std::uint64_t hash) const noexcept -> bool {
+        const auto mixed = detail::mix64(hash + seed);
+        return (fingerprint(mixed) ^ fingerprints[position(0, mixed)] ^
+                fingerprints[position(1, mixed)] ^ fingerprints[position(2, mixed)]) == 0;
+    }
+
+    /**
+     * @brief Checks if the provided input elements are likely to be in the filter.
+     * @param data Data to be searched in the filter.
+     * @return A boolean value specifying whether the input was present or not.
+     */
+    [[nodiscard]] auto search_many(iterable auto&& it) const noexcept {
+        bitvec res{};
+        for (const auto& el : it) {
+            res.push_back(search(el));
+        }
+        return res;
+    }
+
+   private:
+    [[nodiscard]] static constexpr auto fingerprint(const std::uint64_t hash) noexcept
+        -> Fingerprint {
+        return static_cast<Fingerprint>(hash ^ (hash >> 32));
+    }
+
+    /// @brief Position of a fingerprint of a mixed hash, one in each of three segments in a row.
+    [[nodiscard]] auto position(const std::uint32_t idx, const std::uint64_t hash) const noexcept
+        -> std::size_t {
+        const auto first = detail::mul128(hash, segment_count * segment_length).second;
+        const auto low = hash & ((std::uint64_t{1} << 36) - 1);
+        return (first + idx * segment_length) ^ ((low >> (36 - 18 * idx)) & (segment_length - 1));
+    }
+
+    /**
+     * @brief Builds the filter by peeling: every element is mapped to three positions, positions
+     * with a single element are removed one after the other, and the fingerprints are assigned in
+     * the reverse order of removal, which fails with a small probability and is retried with
+     * another seed.
+     * @param hashes Distinct hashes of the elements.
+     */
+    void build(const std::vector<std::uint64_t>& hashes) {
+        const auto size = hashes.size();
+        const auto dsize = static_cast<double>(size);
+        segment_length =
+            size == 0 ? 4
+                      : std::min(max_segment_length,
+                                 std::size_t{1} << static_cast<int>(std::floor(
+                                     std::log(dsize) / std::log(3.33) + 2.25)));
+        const auto factor = size <= 1 ? 0.0 : std::max(1.125, 0.875 + 0.25 * std::log(1e6) /
+                                                                       std::log(dsize));
+        const auto capacity = static_cast<std::size_t>(std::round(dsize * factor));
+        const auto segments = (capacity + segment_length - 1) / segment_length;
+        segment_count = segments <= arity - 1 ? 1 : segments - (arity - 1);
+        const auto length = (segment_count + arity - 1) * segment_length;
+        fingerprints.assign(length, 0);
+
+        std::vector<std::uint64_t> order(size + 1);
+        std::vector<std::uint8_t> found(size);
+        std::vector<std::uint8_t> counts(length);
+        std::vector<std::uint64_t> xors(length);
+        std::vector<std::size_t> alone(length);
+
+        // Buckets of the mixed hashes by their first segment, which keeps the peeling local.
+        int block_bits = 1;
+        while ((std::size_t{1} << block_bits) < segment_count) {
+            block_bits++;
+        }
+        const auto block = std::size_t{1} << block_bits;
+        std::vector<std::size_t> start(block);
+
+        std::uint64_t state = 0x726b2b9d438b9d4dULL;
+        std::size_t stack = 0;
+        for (int iteration = 0; stack != size; iteration++) {
+            if (iteration == max_iterations) {
+                throw std::runtime_error("Binary fuse filter could not be built.");
+            }
+            state += 0x9e3779b97f4a7c15ULL;
+            seed = detail::mix64(state);
+
+            std::ranges::fill(order, 0);
+            std::ranges::fill(counts, 0);
+            std::ranges::fill(xors, 0);
+            order[size] = 1;
+            for (std::size_t idx = 0; idx < block; idx++) {
+                start[idx] = (static_cast<std::uint64_t>(idx) * size) >> block_bits;
+            }
+            for (const auto hash : hashes) {
+                const auto mixed = detail::mix64(hash + seed);
+                auto segment = static_cast<std::size_t>(mixed >> (64 - block_bits));
+                while (order[start[segment]] != 0) {
+                    segment = (segment + 1) & (block - 1);
+                }
+                order[start[segment]++] = mixed;
+            }
+
+            // The count of a position is kept in the upper six bits and the xor of the indices of
+            // the positions of its elements in the lower two.
+            auto error = false;
+            for (std::size_t idx = 0; idx < size; idx++) {
+                const auto hash = order[idx];
+                for (std::uint32_t pos = 0; pos < arity; pos++) {
+                    const auto at = position(pos, hash);
+                    counts[at] = static_cast<std::uint8_t>((counts[at] + 4) ^ pos);
+                    xors[at] ^= hash;
+                    error |= counts[at] < 4;
+                }
+            }
+            if (error) {
+                stack = 0;
+                continue;
+            }
+
+            std::size_t queue = 0;
+            for (std::size_t idx = 0; idx < length; idx++) {
+                alone[queue] = idx;
+                queue += (counts[idx] >> 2) == 1 ? 1 : 0;
+            }
+            stack = 0;
+            while (queue > 0) {
+                const auto idx = alone[--queue];
+                if ((counts[idx] >> 2) != 1) {
+                    continue;
+                }
+                const auto hash = xors[idx];
+                const auto own = static_cast<std::uint32_t>(counts[idx] & 3);
+                found[stack] = static_cast<std::uint8_t>(own);
+                order[stack++] = hash;
+                for (const auto next : {(own + 1) % arity, (own + 2) % arity}) {
+                    const auto at = position(next, hash);
+                    alone[queue] = at;
+                    queue += (counts[at] >> 2) == 2 ? 1 : 0;
+                    counts[at] = static_cast<std::uint8_t>((counts[at] - 4) ^ next);
+                    xors[at] ^= hash;
+                }
+            }
+        }
+
+        for (std::size_t idx = size; idx-- > 0;) {
+            const auto hash = order[idx];
+            const std::array<std::size_t, arity> at = {position(0, hash), position(1, hash),
+                                                       position(2, hash)};
+            const auto own = found[idx];
+            fingerprints[at[own]] = static_cast<Fingerprint>(fingerprint(hash) ^
+                                                             fingerprints[at[(own + 1) % arity]] ^
+                                                             fingerprints[at[(own + 2) % arity]]);
+        }
+    }
+};
+
+/**
+ * @brief A cuckoo filter (Fan, Andersen, Kaminsky, and Mitzenmacher, 2014), which stores a 16-bit
+ * fingerprint of every element in one of two buckets of four slots and supports deletions. At the
+ * 95% load it is sized for, the false positive probability is about 8 / 2^16 at 17 bits per
+ * element. A bucket is a 64-bit word, which is searched for a fingerprint in a few instructions.
+ */
+template <typename Hasher = DefaultHasher>
+struct CuckooFilter {
+    // Number of slots in a bucket.
+    static constexpr std::size_t bucket_slots = 4;
+    // Number of bits in a fingerprint.
+    static constexpr int fingerprint_bits = 16;
+    // Expected load factor of a full filter.
+    static constexpr double max_load = 0.95;
+    // Number of relocations before an insertion gives up.
+    static constexpr int max_kicks = 500;
+
+    // Number of buckets, a power of two.
+    std::size_t buckets;
+    // Buckets, one fingerprint per 16 bits and zero for an empty slot.
+    std::vector<std::uint64_t, AlignedAllocator<std::uint64_t>> words;
+    // Hash function.
+    [[no_unique_address]] Hasher hasher;
+
+    /**
+     * @brief Creates a new, empty cuckoo filter.
+     * @param elems Number of elements that the filter is expected to hold.
+     * @param hash Hash function.
+     */
+    explicit CuckooFilter(const std::uint64_t elems, Hasher hash = {}) : hasher{hash} {
+        if (elems <= 0) {
+            throw std::domain_error("Number of elements must be greater than zero.");
+        }
+        buckets = std::bit_ceil(std::max<std::size_t>(
+            2, static_cast<std::size_t>(std::ceil(static_cast<double>(elems) /
+                                                  (bucket_slots * max_load)))));
+        words.assign(buckets, 0);
+    }
+
+    /**
+     * @brief Inserts a new element into the filter.
+     * @param data Data to be inserted into the filter.
+     * @return A boolean value specifying whether the filter had room for the element.
+     */
+    template <hashable_with<Hasher> T>
+    auto insert(const T& data) noexcept -> bool {
+        return insert_hash(hasher(data));
+    }
+
+    /**
+     * @brief Inserts an element, which has already been hashed with `hasher`, into the filter. The
+     * insertion fails once the filter is so full that an element had to be set aside.
+     * @param hash Hash of the element.
+     * @return A boolean value specifying whether the filter had room for the element.
+     */
+    auto insert_hash(const std::uint64_t hash) noexcept -> bool {
+        if (victim_) {
+            return false;
+        }
+        const auto fp = fingerprint(hash);
+        const auto first = index(hash);
+        size_++;
+        if (add(first, fp) || add(alternate(first, fp), fp)) {
+            return true;
+        }
+        relocate((hash >> 63) != 0 ? alternate(first, fp) : first, fp);
+        return true;
+    }
+
+    /**
+     * @brief Inserts elements from the provided iterable into the filter.
+     * @param it An iterable containing elements to be inserted into the filter.
+     * @return A boolean value specifying whether the filter had room for all of the elements.
+     */
+    auto insert_many(iterable auto&& it) noexcept -> bool {
+        auto res = true;
+        for (const auto& el : it) {
+            res &= insert(el);
+        }
+        return res;
+    }
 
-template <typename T>
-concept iterable = std::ranges::forward_range<T>;
+    /**
+     * @brief Removes an element from the filter. Only elements which were inserted should be
+     * removed, since removing a false positive removes another element.
+     * @param data Data to be removed from the filter.
+     * @return A boolean value specifying whether the element was present and removed.
+     */
+    template <hashable_with<Hasher> T>
+    auto erase(const T& data) noexcept -> bool {
+        return erase_hash(hasher(data));
+    }
 
-template <typename T>
-concept arithmetic = std::is_floating_point_v<T>;
+    /**
+     * @brief Removes an element, which has already been hashed with `hasher`, from the filter.
+     * @param hash Hash of the element.
+     * @return A boolean value specifying whether the element was present and removed.
+     */
+    auto erase_hash(const std::uint64_t hash) noexcept -> bool {
+        const auto fp = fingerprint(hash);
+        const auto first = index(hash);
+        const auto second = alternate(first, fp);
+        if (victim_ && victim_->second == fp &&
+            (victim_->first == first || victim_->first == second)) {
+            victim_.reset();
+            size_--;
+            return true;
+        }
+        if (!remove(first, fp) && !remove(second, fp)) {
+            return false;
+        }
+        size_--;
+        // The slot which was freed may make room for the element that was set aside.
+        if (victim_) {
+            const auto [bucket, victim] = *victim_;
+            victim_.reset();
+            relocate(bucket, victim);
+        }
+        return true;
+    }
 
-using bitvec = std::vector<bool>;
+    /**
+     * @brief Checks if the provided input is likely to be in the filter.
+     * @param data Data to be searched in the filter.
+     * @return A boolean value specifying whether the input was present or not.
+     */
+    template <hashable_with<Hasher> T>
+    [[nodiscard]] auto search(const T& data) const noexcept {
+        return search_hash(hasher(data));
+    }
+
+    /**
+     * @brief Checks if an element, which has already been hashed with `hasher`, is likely to be in
+     * the filter.
+     * @param hash Hash of the element.
+     * @return A boolean value specifying whether the element was present or not.
+     */
+    [[nodiscard]] auto search_hash(const std::uint64_t hash) const noexcept -> bool {
+        const auto fp = fingerprint(hash);
+        const auto first = index(hash);
+        const auto second = alternate(first, fp);
+        return contains(words[first], fp) || contains(words[second], fp) ||
+               (victim_ && victim_->second == fp &&
+                (victim_->first == first || victim_->first == second));
+    }
+
+    /**
+     * @brief Checks if the provided input elements are likely to be in the filter.
+     * @param data Data to be searched in the filter.
+     * @return A boolean value specifying whether the input was present or not.
+     */
+    [[nodiscard]] auto search_many(iterable auto&& it) const noexcept {
+        bitvec res{};
+        for (const auto& el : it) {
+            res.push_back(search(el));
+        }
+        return res;
+    }
+
+    /// @brief Number of elements in the filter.
+    [[nodiscard]] auto size() const noexcept -> std::uint64_t {
+        return size_;
+    }
+
+    /**
+     * @brief Clears the filter.
+     */
+    void clear() noexcept {
+        std::ranges::fill(words, 0);
+        victim_.reset();
+        size_ = 0;
+    }
+
+   private:
+    // A one in every slot of a bucket.
+    static constexpr std::uint64_t slot_ones = 0x0001000100010001ULL;
+    // The top bit of every slot of a bucket.
+    static constexpr std::uint64_t slot_highs = 0x8000800080008000ULL;
+    static constexpr std::uint64_t slot_mask = (std::uint64_t{1} << fingerprint_bits) - 1;
+
+    [[nodiscard]] static constexpr auto fingerprint(const std::uint64_t hash) noexcept
+        -> std::uint64_t {
+        const auto res = (hash >> 32) & slot_mask;
+        return res == 0 ? 1 : res;
+    }
+
+    [[nodiscard]] auto index(const std::uint64_t hash) const noexcept -> std::size_t {
+        return hash & (buckets - 1);
+    }
+
+    /// @brief The other bucket of a fingerprint, which maps back to the first one.
+    [[nodiscard]] auto alternate(const std::size_t bucket, const std::uint64_t fp) const noexcept
+        -> std::size_t {
+        return (bucket ^ (fp * 0x5bd1e995)) & (buckets - 1);
+    }
+
+    /// @brief Checks whether a bucket holds a fingerprint, with all four slots compared at once.
+    [[nodiscard]] static constexpr auto contains(const std::uint64_t word,
+                                                 const std::uint64_t fp) noexcept -> bool {
+        const auto diff = word ^ (fp * slot_ones);
+        return ((diff - slot_ones) & ~diff & slot_highs) != 0;
+    }
+
+    auto add(const std::size_t bucket, const std::uint64_t fp) noexcept -> bool {
+        auto& word = words[bucket];
+        for (std::size_t slot = 0; slot < bucket_slots; slot++) {
+            const auto shift = slot * fingerprint_bits;
+            if (((word >> shift) & slot_mask) == 0) {
+                word |= fp << shift;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    auto remove(const std::size_t bucket, const std::uint64_t fp) noexcept -> bool {
+        auto& word = words[bucket];
+        for (std::size_t slot = 0; slot < bucket_slots; slot++) {
+            const auto shift = slot * fingerprint_bits;
+            if (((word >> shift) & slot_mask) == fp) {
+                word &= ~(slot_mask << shift);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Makes room for a fingerprint by moving the fingerprints of full buckets to their
+     * other buckets, and sets the last moved fingerprint aside if that does not free a slot.
+     * @param bucket Bucket of the fingerprint.
+     * @param fp Fingerprint.
+     */
+    void relocate(std::size_t bucket, std::uint64_t fp) noexcept {
+        for (int kick = 0; kick < max_kicks; kick++) {
+            if (add(bucket, fp)) {
+                return;
+            }
+            rng_ = rng_ * 6364136223846793005ULL + 1442695040888963407ULL;
+            const auto shift = (rng_ >> 62) * fingerprint_bits;
+            auto& word = words[bucket];
+            const auto evicted = (word >> shift) & slot_mask;
+            word = (word & ~(slot_mask << shift)) | (fp << shift);
+            fp = evicted;
+            bucket = alternate(bucket, fp);
+        }
+        victim_ = {bucket, fp};
+    }
+
+    // Bucket and fingerprint of the element which was set aside.
+    std::optional<std::pair<std::size_t, std::uint64_t>> victim_;
+    std::uint64_t size_{};
+    std::uint64_t rng_{0x853c49e6748fea9bULL};
+};
 
 /**
- * @brief A zero-dependency bloom filter implementation. The data structure provides efficient
- * data storage and lookup. It is important to note that due to the probabilistic nature of the
- * data structure, there is a chance for false positive results. In other words, after inserting
- * data into the bloom filter, a lookup can either tell that the data is present with some
- * probability of the false positive outcome or tell that the data is definitely not present in
- * the data structure.
+ * @brief A bloom filter that can be inserted into and searched from many threads at once. The words
+ * of the bit vector are updated with relaxed atomic operations: an insertion only issues a
+ * read-modify-write for the words in which its bit is not set yet and a lookup is a sequence of
+ * relaxed loads, so that both are lock-free and lookups are wait-free. The layout of the bit
+ * vector is that of `BloomFilter`.
  */
-struct BloomFilter {
+template <typename Hasher = DefaultHasher, typename Reducer = FastRange>
+struct ConcurrentBloomFilter {
     // Number of bits in the bit vector.
     std::size_t bits;
     // Number of hash functions.
     std::uint64_t hash_fns;
     // Bit vector.
-    bitvec bvec;
+    BitArray bvec;
+    // Hash function.
+    [[no_unique_address]] Hasher hasher;
 
     /**
-     * @brief Creates a new bloom filter with optimal parameters.
+     * @brief Creates a new concurrent bloom filter with optimal parameters.
      * @param n An approximate number of elements to be inserted.
      * @param eps False positive probability.
+     * @param hash Hash function.
      */
-    explicit constexpr BloomFilter(const std::uint64_t elems, const arithmetic auto eps) {
-        if (elems <= 0) {
-            throw std::domain_error("Number of elements must be greater than zero.");
-        }
-        if (eps < 0 || eps > 1) {
-            throw std::domain_error("False positive probability must be between zero and one.");
-        }
-
-        bits = -std::ceil(elems * std::log(eps) / std::pow(std::log(2), 2));
-        hash_fns = std::ceil(static_cast<float>(bits) / static_cast<float>(elems) * std::log(2));
-        bvec = std::vector(bits, false);
+    explicit ConcurrentBloomFilter(const std::uint64_t elems, const arithmetic auto eps,
+                                   Hasher hash = {})
+        : hasher{hash} {
+        std::tie(bits, hash_fns) = detail::optimal_parameters<Reducer>(elems, eps);
+        bvec = BitArray(bits);
     }
 
     /**
-     * @brief Inserts a new element into the bloom filter.
+     * @brief Inserts a new element into the bloom filter. Safe to call from many threads.
      * @param data Data to be inserted into a bloom filter.
      */
-    template <hashable T>
-    constexpr void insert(T data) noexcept {
-        auto hash = std::hash<T>{};
-        for (std::size_t idx = 0; idx < hash_fns; idx++) {
-            bvec[(hash(data) + idx << 2) % bits] = true;
-        }
+    template <hashable_with<Hasher> T>
+    void insert(const T& data) noexcept {
+        insert_hash(hasher(data));
     }
 
     /**
-     * @brief Inserts elements from the provided iterable into the bloom filter.
+     * @brief Inserts an element, which has already been hashed with `hasher`, into the bloom
+     * filter. Safe to call from many threads.
+     * @param hash Hash of the element.
+     */
+    void insert_hash(const std::uint64_t hash) noexcept {
+        detail::insert_atomic<Reducer>(bvec, bits, hash_fns, hash);
+    }
+
+    /**
+     * @brief Inserts elements from the provided iterable into the bloom filter. Safe to call from
+     * many threads.
      * @param it An iterable containing elements to be inserted into the bloom filter.
      */
-    constexpr void insert_many(iterable auto it) noexcept {
+    void insert_many(iterable auto&& it) noexcept {
         for (const auto& el : it) {
             insert(el);
         }
     }
 
     /**
-     * @brief Checks if the provided input is likely to be in the bloom filter.
+     * @brief Checks if the provided input is likely to be in the bloom filter. Safe to call from
+     * many threads, including concurrently with insertions.
      * @param data Data to be searched in the bloom filter.
      * @return A boolean value specifying whether the input was present or not.
      */
-    template <hashable T>
-    [[nodiscard]] constexpr auto search(T data) const noexcept {
-        auto hash = std::hash<T>{};
+    template <hashable_with<Hasher> T>
+    [[nodiscard]] auto search(const T& data) const noexcept {
+        return search_hash(hasher(data));
+    }
+
+    /**
+     * @brief Checks if an element, which has already been hashed with `hasher`, is likely to be in
+     * the bloom filter. Safe to call from many threads, including concurrently with insertions.
+     * @param hash Hash of the element.
+     * @return A boolean value specifying whether the element was present or not.
+     */
+    [[nodiscard]] auto search_hash(const std::uint64_t hash) const noexcept -> bool {
+        const auto probes = detail::Probes{hash};
         for (std::size_t idx = 0; idx < hash_fns; idx++) {
-            if (!bvec[(hash(data) + idx << 2) % bits]) {
+            const auto bit = Reducer::reduce(probes[idx], bits);
+            const auto mask = std::uint64_t{1} << (bit % BitArray::word_bits);
+            const auto word = detail::atomic_word(bvec, bit / BitArray::word_bits);
+            if ((word.load(std::memory_order_relaxed) & mask) == 0) {
                 return false;
             }
         }
@@ -127,7 +5151,7 @@ struct BloomFilter {
      * @param data Data to be searched in the bloom filter.
      * @return A boolean value specifying whether the input was present or not.
      */
-    [[nodiscard]] auto search_many(iterable auto it) const noexcept {
+    [[nodiscard]] auto search_many(iterable auto&& it) const noexcept {
         bitvec res{};
         for (const auto& el : it) {
             res.push_back(search(el));
@@ -136,13 +5160,375 @@ struct BloomFilter {
     }
 
     /**
-     * @brief Clears the bloom filter.
+     * @brief Clears the bloom filter. Insertions that run concurrently with clearing may or may not
+     * survive it.
      */
     auto clear() noexcept {
-        bvec = std::vector(bits, false);
+        for (std::size_t idx = 0; idx < bvec.words(); idx++) {
+            detail::atomic_word(bvec, idx).store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+#if defined(BF_HAS_MMAP)
+
+namespace detail {
+
+/**
+ * @brief A read-only memory mapping of a file written by the `save` of a filter, whose header has
+ * been validated against the layout and the policies of the filter which maps it.
+ */
+class MappedFile {
+   public:
+    /**
+     * @brief Maps a serialized filter.
+     * @param path Path to the file.
+     * @param layout Layout of the filter.
+     * @param hasher_id Identifier of the hash function.
+     * @param reducer_id Identifier of the reduction.
+     * @param hasher_seed Seed of the hash function.
+     * @param verify Whether to check the words against the checksum, which reads the whole file.
+     */
+    MappedFile(const std::string& path, const Layout layout, const std::uint32_t hasher_id,
+               const std::uint32_t reducer_id, const std::uint64_t hasher_seed, const bool verify) {
+        const auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "Failed to open " + path);
+        }
+        struct stat info {};
+        if (::fstat(fd, &info) != 0) {
+            const auto err = errno;
+            ::close(fd);
+            throw std::system_error(err, std::generic_category(), "Failed to stat " + path);
+        }
+        size_ = static_cast<std::size_t>(info.st_size);
+        if (size_ < sizeof(Header)) {
+            ::close(fd);
+            throw std::runtime_error("Input is not a serialized bloom filter.");
+        }
+        map_ = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        const auto err = errno;
+        ::close(fd);
+        if (map_ == MAP_FAILED) {
+            map_ = nullptr;
+            throw std::system_error(err, std::generic_category(), "Failed to map " + path);
+        }
+
+        try {
+            std::memcpy(&header_, map_, sizeof(header_));
+            header_.validate(layout, hasher_id, reducer_id, hasher_seed);
+            if (header_.encoding != Encoding::raw) {
+                throw std::runtime_error("Compressed bloom filters cannot be memory-mapped.");
+            }
+            if (header_.words > (size_ - sizeof(header_)) / sizeof(std::uint64_t)) {
+                throw std::runtime_error("Serialized bloom filter is truncated.");
+            }
+            data_ = reinterpret_cast<const std::uint64_t*>(static_cast<const std::byte*>(map_) +
+                                                           sizeof(header_));
+            if (verify && checksum(data_, header_.words) != header_.checksum) {
+                throw std::runtime_error("Checksum of the serialized bloom filter does not match.");
+            }
+            // Probes are scattered, so that reading ahead only pollutes the page cache.
+            ::madvise(map_, size_, MADV_RANDOM);
+        } catch (...) {
+            ::munmap(map_, size_);
+            throw;
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    auto operator=(const MappedFile&) -> MappedFile& = delete;
+
+    MappedFile(MappedFile&& other) noexcept
+        : map_{std::exchange(other.map_, nullptr)},
+          size_{std::exchange(other.size_, 0)},
+          header_{other.header_},
+          data_{std::exchange(other.data_, nullptr)} {}
+
+    auto operator=(MappedFile&& other) noexcept -> MappedFile& {
+        std::swap(map_, other.map_);
+        std::swap(size_, other.size_);
+        std::swap(header_, other.header_);
+        std::swap(data_, other.data_);
+        return *this;
+    }
+
+    ~MappedFile() {
+        if (map_ != nullptr) {
+            ::munmap(map_, size_);
+        }
+    }
+
+    /// @brief Header of the filter.
+    [[nodiscard]] auto header() const noexcept -> const Header& {
+        return header_;
+    }
+
+    /// @brief Words of the bit vector.
+    [[nodiscard]] auto data() const noexcept -> const std::uint64_t* {
+        return data_;
+    }
+
+   private:
+    void* map_{};
+    std::size_t size_{};
+    Header header_{};
+    const std::uint64_t* data_{};
+};
+
+}  // namespace detail
+
+/**
+ * @brief A read-only bloom filter which is memory-mapped from a file written by
+ * `BloomFilter::save`. Lookups are answered straight from the page cache, with no parsing or
+ * copying, so that opening the filter is cheap and all of the processes which map the same file
+ * share a single physical copy of it.
+ */
+template <typename Hasher = DefaultHasher, typename Reducer = FastRange>
+class MappedBloomFilter {
+   public:
+    /**
+     * @brief Maps a serialized bloom filter.
+     * @param path Path to the file.
+     * @param verify Whether to check the words against the checksum, which reads the whole file.
+     * @param hash Hash function, with the seed that the filter was saved with.
+     */
+    explicit MappedBloomFilter(const std::string& path, const bool verify = false,
+                               Hasher hash = {})
+        : file_{path,
+                detail::Layout::standard,
+                detail::policy_id<Hasher>,
+                detail::policy_id<Reducer>,
+                detail::hasher_seed(hash),
+                verify},
+          hasher_{hash} {}
+
+    /// @brief Number of bits in the bit vector.
+    [[nodiscard]] auto bits() const noexcept -> std::size_t {
+        return file_.header().bits;
+    }
+
+    /// @brief Number of hash functions.
+    [[nodiscard]] auto hash_fns() const noexcept -> std::uint64_t {
+        return file_.header().hash_fns;
+    }
+
+    /// @brief Number of words in the bit vector.
+    [[nodiscard]] auto words() const noexcept -> std::size_t {
+        return file_.header().words;
+    }
+
+    /// @brief Words of the bit vector.
+    [[nodiscard]] auto data() const noexcept -> const std::uint64_t* {
+        return file_.data();
+    }
+
+    /**
+     * @brief Checks if the provided input is likely to be in the bloom filter.
+     * @param data Data to be searched in the bloom filter.
+     * @return A boolean value specifying whether the input was present or not.
+     */
+    template <hashable_with<Hasher> T>
+    [[nodiscard]] auto search(const T& data) const noexcept {
+        return search_hash(hasher_(data));
+    }
+
+    /**
+     * @brief Checks if an element, which has already been hashed with the hash function of the
+     * filter, is likely to be in the bloom filter.
+     * @param hash Hash of the element.
+     * @return A boolean value specifying whether the element was present or not.
+     */
+    [[nodiscard]] auto search_hash(const std::uint64_t hash) const noexcept -> bool {
+        return detail::search_words<Reducer>(data(), bits(), hash_fns(), hash);
+    }
+
+    /**
+     * @brief Checks if the provided input elements are likely to be in the bloom filter.
+     * @param data Data to be searched in the bloom filter.
+     * @return A boolean value specifying whether the input was present or not.
+     */
+    [[nodiscard]] auto search_many(iterable auto&& it) const noexcept {
+        bitvec res{};
+        for (const auto& el : it) {
+            res.push_back(search(el));
+        }
+        return res;
+    }
+
+    /**
+     * @brief Checks if the provided input elements are likely to be in the bloom filter with the
+     * batched SIMD kernels (see `BloomFilter::search_many`).
+     * @param it An iterable containing elements to be searched in the bloom filter.
+     * @param res Output, one byte per element which is one if the element was present and zero
+     * otherwise. It must hold at least as many bytes as there are elements.
+     */
+    void search_many(iterable auto&& it, std::span<std::uint8_t> res) const {
+        detail::for_each_batch(hasher_, it, [&](const detail::Probes* probes, const std::size_t n) {
+            if (res.size() < n) {
+                throw std::length_error("Result buffer is smaller than the number of elements.");
+            }
+            detail::search_batch<Reducer>(data(), bits(), hash_fns(), probes, n, res.data());
+            res = res.subspan(n);
+        });
+    }
+
+   private:
+    detail::MappedFile file_;
+    [[no_unique_address]] Hasher hasher_;
+};
+
+/**
+ * @brief A read-only blocked bloom filter which is memory-mapped from a file written by
+ * `BlockedBloomFilter::save`, so that every lookup reads a single cache line of the page cache.
+ */
+template <typename Hasher = DefaultHasher, typename Reducer = FastRange>
+class MappedBlockedBloomFilter {
+   public:
+    using filter_type = BlockedBloomFilter<Hasher, Reducer>;
+
+    /**
+     * @brief Maps a serialized blocked bloom filter.
+     * @param path Path to the file.
+     * @param verify Whether to check the words against the checksum, which reads the whole file.
+     * @param hash Hash function, with the seed that the filter was saved with.
+     */
+    explicit MappedBlockedBloomFilter(const std::string& path, const bool verify = false,
+                                      Hasher hash = {})
+        : file_{path,
+                detail::Layout::blocked,
+                detail::policy_id<Hasher>,
+                detail::policy_id<Reducer>,
+                detail::hasher_seed(hash),
+                verify},
+          hasher_{hash} {}
+
+    /// @brief Number of blocks in the bit vector.
+    [[nodiscard]] auto blocks() const noexcept -> std::size_t {
+        return file_.header().bits / filter_type::block_bits;
     }
+
+    /// @brief Number of bits in the bit vector.
+    [[nodiscard]] auto bits() const noexcept -> std::size_t {
+        return file_.header().bits;
+    }
+
+    /// @brief Number of hash functions.
+    [[nodiscard]] auto hash_fns() const noexcept -> std::uint64_t {
+        return file_.header().hash_fns;
+    }
+
+    /**
+     * @brief Checks if the provided input is likely to be in the bloom filter.
+     * @param data Data to be searched in the bloom filter.
+     * @return A boolean value specifying whether the input was present or not.
+     */
+    template <hashable_with<Hasher> T>
+    [[nodiscard]] auto search(const T& data) const noexcept {
+        return search_hash(hasher_(data));
+    }
+
+    /**
+     * @brief Checks if an element, which has already been hashed with the hash function of the
+     * filter, is likely to be in the bloom filter.
+     * @param hash Hash of the element.
+     * @return A boolean value specifying whether the element was present or not.
+     */
+    [[nodiscard]] auto search_hash(const std::uint64_t hash) const noexcept -> bool {
+        return filter_type::search_words(file_.data(), blocks(), hash_fns(), hash);
+    }
+
+    /**
+     * @brief Checks if the provided input elements are likely to be in the bloom filter.
+     * @param data Data to be searched in the bloom filter.
+     * @return A boolean value specifying whether the input was present or not.
+     */
+    [[nodiscard]] auto search_many(iterable auto&& it) const noexcept {
+        bitvec res{};
+        for (const auto& el : it) {
+            res.push_back(search(el));
+        }
+        return res;
+    }
+
+   private:
+    detail::MappedFile file_;
+    [[no_unique_address]] Hasher hasher_;
+};
+
+/**
+ * @brief A read-only split-block bloom filter which is memory-mapped from a file written by
+ * `SplitBlockBloomFilter::save`.
+ */
+template <typename Hasher = XXHash64>
+class MappedSplitBlockBloomFilter {
+   public:
+    using filter_type = SplitBlockBloomFilter<Hasher>;
+
+    /**
+     * @brief Maps a serialized split-block bloom filter.
+     * @param path Path to the file.
+     * @param verify Whether to check the words against the checksum, which reads the whole file.
+     * @param hash Hash function, with the seed that the filter was saved with.
+     */
+    explicit MappedSplitBlockBloomFilter(const std::string& path, const bool verify = false,
+                                         Hasher hash = {})
+        : file_{path, detail::Layout::split_block, detail::policy_id<Hasher>, 0,
+                detail::hasher_seed(hash), verify},
+          hasher_{hash} {}
+
+    /// @brief Number of blocks.
+    [[nodiscard]] auto blocks() const noexcept -> std::size_t {
+        return file_.header().bits / (filter_type::block_bytes * 8);
+    }
+
+    /// @brief Bytes of the filter, in the layout of a Parquet bloom filter bitset.
+    [[nodiscard]] auto bytes() const noexcept -> std::span<const std::byte> {
+        return std::as_bytes(std::span{file_.data(), file_.header().words});
+    }
+
+    /**
+     * @brief Checks if the provided input is likely to be in the bloom filter.
+     * @param data Data to be searched in the bloom filter.
+     * @return A boolean value specifying whether the input was present or not.
+     */
+    template <hashable_with<Hasher> T>
+    [[nodiscard]] auto search(const T& data) const noexcept {
+        return search_hash(hasher_(data));
+    }
+
+    /**
+     * @brief Checks if an element, which has already been hashed with the hash function of the
+     * filter, is likely to be in the bloom filter.
+     * @param hash Hash of the element.
+     * @return A boolean value specifying whether the element was present or not.
+     */
+    [[nodiscard]] auto search_hash(const std::uint64_t hash) const noexcept -> bool {
+        // The mapping has no declared type, so that its words can be read as 32-bit words.
+        return filter_type::search_words(reinterpret_cast<const std::uint32_t*>(file_.data()),
+                                         blocks(), hash);
+    }
+
+    /**
+     * @brief Checks if the provided input elements are likely to be in the bloom filter.
+     * @param data Data to be searched in the bloom filter.
+     * @return A boolean value specifying whether the input was present or not.
+     */
+    [[nodiscard]] auto search_many(iterable auto&& it) const noexcept {
+        bitvec res{};
+        for (const auto& el : it) {
+            res.push_back(search(el));
+        }
+        return res;
+    }
+
+   private:
+    detail::MappedFile file_;
+    [[no_unique_address]] Hasher hasher_;
 };
 
+#endif
+
 }  // namespace bf
 
 #endif  // BF_H
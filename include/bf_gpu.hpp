@@ -0,0 +1,627 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 David Oniani
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef BF_GPU_H
+#define BF_GPU_H
+
+/**
+ * @brief Blocked and split-block bloom filters whose bits live in the memory of an OpenMP offload
+ * device, such as a GPU, and which are built and searched there in bulk. The bits and the hashes
+ * are those of `bf::BlockedBloomFilter` and `bf::SplitBlockBloomFilter`, so that a filter built on
+ * the device is saved in the host format and can be loaded or memory-mapped on the host. Without
+ * an offload device, the kernels run on the host.
+ */
+
+#if !defined(_OPENMP)
+#error "bf_gpu.hpp requires OpenMP, such as -fopenmp."
+#endif
+
+#include <omp.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "bf.hpp"
+
+namespace bf::gpu {
+
+namespace detail {
+
+/**
+ * @brief Words in the memory of an offload device, which are zeroed on allocation.
+ */
+template <typename Word>
+class DeviceWords {
+   public:
+    /**
+     * @brief Allocates zeroed words on a device.
+     * @param n Number of words.
+     * @param device Device number.
+     * @throws std::bad_alloc If the device is out of memory.
+     */
+    DeviceWords(const std::size_t n, const int device) : size_{n}, device_{device} {
+        data_ = static_cast<Word*>(omp_target_alloc(n * sizeof(Word), device));
+        if (data_ == nullptr) {
+            throw std::bad_alloc();
+        }
+        zero();
+    }
+
+    DeviceWords(const DeviceWords&) = delete;
+    auto operator=(const DeviceWords&) -> DeviceWords& = delete;
+
+    DeviceWords(DeviceWords&& other) noexcept
+        : data_{std::exchange(other.data_, nullptr)},
+          size_{std::exchange(other.size_, 0)},
+          device_{other.device_} {}
+
+    auto operator=(DeviceWords&& other) noexcept -> DeviceWords& {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(device_, other.device_);
+        return *this;
+    }
+
+    ~DeviceWords() {
+        if (data_ != nullptr) {
+            omp_target_free(data_, device_);
+        }
+    }
+
+    /// @brief Device pointer to the words.
+    [[nodiscard]] auto data() const noexcept -> Word* {
+        return data_;
+    }
+
+    /// @brief Number of words.
+    [[nodiscard]] auto size() const noexcept -> std::size_t {
+        return size_;
+    }
+
+    /// @brief Device number.
+    [[nodiscard]] auto device() const noexcept -> int {
+        return device_;
+    }
+
+    /// @brief Zeroes the words on the device.
+    void zero() noexcept {
+        auto* const words = data_;
+        const auto n = size_;
+#pragma omp target teams distribute parallel for device(device_) is_device_ptr(words)
+        for (std::size_t idx = 0; idx < n; idx++) {
+            words[idx] = 0;
+        }
+    }
+
+    /**
+     * @brief Copies words from the host to the device.
+     * @param src Words on the host, as many as there are on the device.
+     */
+    void upload(const Word* src) {
+        copy(data_, src, device_, omp_get_initial_device());
+    }
+
+    /**
+     * @brief Copies the words from the device to the host.
+     * @param dst Words on the host, as many as there are on the device.
+     */
+    void download(Word* dst) const {
+        copy(dst, data_, omp_get_initial_device(), device_);
+    }
+
+   private:
+    void copy(Word* dst, const Word* src, const int dst_device, const int src_device) const {
+        if (size_ != 0 && omp_target_memcpy(dst, src, size_ * sizeof(Word), 0, 0, dst_device,
+                                            src_device) != 0) {
+            throw std::runtime_error("Failed to copy the words of a device filter.");
+        }
+    }
+
+    Word* data_;
+    std::size_t size_;
+    int device_;
+};
+
+/// @brief Checks that a result buffer holds a byte for every key.
+inline void check_results(const std::size_t keys, const std::size_t results) {
+    if (results < keys) {
+        throw std::length_error("Result buffer is smaller than the number of elements.");
+    }
+}
+
+}  // namespace detail
+
+/**
+ * @brief A blocked bloom filter in the memory of an offload device, with the bits of a
+ * `bf::BlockedBloomFilter` of the same parameters. Every key is handled by one device thread,
+ * which computes the eight word masks of its block and sets them with atomic ors, or compares the
+ * words of the block against them. Integer keys are hashed on the device with `Hasher`, which
+ * must be callable in a target region; keys of any other type can be hashed on the host and passed
+ * as hashes.
+ */
+template <typename Hasher = DefaultHasher, typename Reducer = FastRange>
+class BlockedBloomFilter {
+   public:
+    using filter_type = bf::BlockedBloomFilter<Hasher, Reducer>;
+
+    /**
+     * @brief Creates a new blocked bloom filter on a device, with the parameters that the host
+     * filter would be created with.
+     * @param n An approximate number of elements to be inserted.
+     * @param eps False positive probability.
+     * @param hash Hash function.
+     * @param device Device number.
+     */
+    BlockedBloomFilter(const std::uint64_t elems, const arithmetic auto eps, Hasher hash = {},
+                       const int device = omp_get_default_device())
+        : BlockedBloomFilter{filter_type::parameters(elems, eps), hash, device} {}
+
+    /**
+     * @brief Copies a host filter to a device.
+     * @param filter Host filter.
+     * @param device Device number.
+     */
+    explicit BlockedBloomFilter(const filter_type& filter,
+                                const int device = omp_get_default_device())
+        : BlockedBloomFilter{{filter.blocks, filter.hash_fns}, filter.hasher, device} {
+        words_.upload(filter.bvec.data());
+    }
+
+    /// @brief Number of blocks in the bit vector.
+    [[nodiscard]] auto blocks() const noexcept -> std::size_t {
+        return blocks_;
+    }
+
+    /// @brief Number of bits in the bit vector.
+    [[nodiscard]] auto bits() const noexcept -> std::size_t {
+        return blocks_ * block_bits;
+    }
+
+    /// @brief Number of hash functions.
+    [[nodiscard]] auto hash_fns() const noexcept -> std::uint64_t {
+        return hash_fns_;
+    }
+
+    /// @brief Device number.
+    [[nodiscard]] auto device() const noexcept -> int {
+        return words_.device();
+    }
+
+    /// @brief Device pointer to the words of the bit vector, for kernels of the caller.
+    [[nodiscard]] auto data() const noexcept -> std::uint64_t* {
+        return words_.data();
+    }
+
+    /**
+     * @brief Inserts integer keys, which are hashed on the device.
+     * @param keys Keys on the host.
+     */
+    template <typename T>
+        requires std::is_integral_v<T> && hashable_with<T, Hasher>
+    void insert(const std::span<const T> keys) {
+        if (keys.empty()) {
+            return;
+        }
+        const auto* const ptr = keys.data();
+        const auto n = keys.size();
+        const auto hash = hasher_;
+        const auto* const salts = filter_type::salts.data();
+        auto* const words = words_.data();
+        const auto blocks = blocks_;
+        const auto hash_fns = hash_fns_;
+#pragma omp target teams distribute parallel for device(words_.device()) is_device_ptr(words) \
+    map(to : ptr[0 : n], salts[0 : hash_fns]) firstprivate(hash)
+        for (std::size_t idx = 0; idx < n; idx++) {
+            set(words, blocks, hash_fns, salts, hash(ptr[idx]));
+        }
+    }
+
+    /**
+     * @brief Inserts elements which have already been hashed with `hasher` on the host.
+     * @param hashes Hashes of the elements.
+     */
+    void insert_hashes(const std::span<const std::uint64_t> hashes) {
+        if (hashes.empty()) {
+            return;
+        }
+        const auto* const ptr = hashes.data();
+        const auto n = hashes.size();
+        const auto* const salts = filter_type::salts.data();
+        auto* const words = words_.data();
+        const auto blocks = blocks_;
+        const auto hash_fns = hash_fns_;
+#pragma omp target teams distribute parallel for device(words_.device()) is_device_ptr(words) \
+    map(to : ptr[0 : n], salts[0 : hash_fns])
+        for (std::size_t idx = 0; idx < n; idx++) {
+            set(words, blocks, hash_fns, salts, ptr[idx]);
+        }
+    }
+
+    /**
+     * @brief Checks if integer keys, which are hashed on the device, are likely to be in the bloom
+     * filter.
+     * @param keys Keys on the host.
+     * @param res Output, one byte per key which is one if the key was present and zero otherwise.
+     * @throws std::length_error If `res` is smaller than `keys`.
+     */
+    template <typename T>
+        requires std::is_integral_v<T> && hashable_with<T, Hasher>
+    void search(const std::span<const T> keys, const std::span<std::uint8_t> res) const {
+        detail::check_results(keys.size(), res.size());
+        if (keys.empty()) {
+            return;
+        }
+        const auto* const ptr = keys.data();
+        const auto n = keys.size();
+        auto* const out = res.data();
+        const auto hash = hasher_;
+        const auto* const salts = filter_type::salts.data();
+        const auto* const words = words_.data();
+        const auto blocks = blocks_;
+        const auto hash_fns = hash_fns_;
+#pragma omp target teams distribute parallel for device(words_.device()) is_device_ptr(words) \
+    map(to : ptr[0 : n], salts[0 : hash_fns]) map(from : out[0 : n]) firstprivate(hash)
+        for (std::size_t idx = 0; idx < n; idx++) {
+            out[idx] = test(words, blocks, hash_fns, salts, hash(ptr[idx]));
+        }
+    }
+
+    /**
+     * @brief Checks if elements, which have already been hashed with `hasher` on the host, are
+     * likely to be in the bloom filter.
+     * @param hashes Hashes of the elements.
+     * @param res Output, one byte per element which is one if the element was present and zero
+     * otherwise.
+     * @throws std::length_error If `res` is smaller than `hashes`.
+     */
+    void search_hashes(const std::span<const std::uint64_t> hashes,
+                       const std::span<std::uint8_t> res) const {
+        detail::check_results(hashes.size(), res.size());
+        if (hashes.empty()) {
+            return;
+        }
+        const auto* const ptr = hashes.data();
+        const auto n = hashes.size();
+        auto* const out = res.data();
+        const auto* const salts = filter_type::salts.data();
+        const auto* const words = words_.data();
+        const auto blocks = blocks_;
+        const auto hash_fns = hash_fns_;
+#pragma omp target teams distribute parallel for device(words_.device()) is_device_ptr(words) \
+    map(to : ptr[0 : n], salts[0 : hash_fns]) map(from : out[0 : n])
+        for (std::size_t idx = 0; idx < n; idx++) {
+            out[idx] = test(words, blocks, hash_fns, salts, ptr[idx]);
+        }
+    }
+
+    /**
+     * @brief Clears the bloom filter on the device.
+     */
+    void clear() noexcept {
+        words_.zero();
+    }
+
+    /**
+     * @brief Copies the bloom filter to the host.
+     * @return The host filter, with the same bits.
+     */
+    [[nodiscard]] auto to_host() const -> filter_type {
+        auto res = filter_type{{blocks_, hash_fns_}, hasher_};
+        words_.download(res.bvec.data());
+        return res;
+    }
+
+    /**
+     * @brief Writes the bloom filter to a stream, in the format of `bf::BlockedBloomFilter::save`,
+     * through a copy on the host.
+     * @param os Output stream.
+     * @param compression Compression of the bit vector.
+     */
+    void save(std::ostream& os, const Compression compression = Compression::none) const {
+        to_host().save(os, compression);
+    }
+
+    /// @brief Hash function.
+    [[nodiscard]] auto hasher() const noexcept -> const Hasher& {
+        return hasher_;
+    }
+
+   private:
+    static constexpr auto block_bits = filter_type::block_bits;
+    static constexpr auto block_words = block_bits / 64;
+
+    BlockedBloomFilter(const std::pair<std::size_t, std::uint64_t> params, Hasher hash,
+                       const int device)
+        : blocks_{params.first},
+          hash_fns_{params.second},
+          hasher_{hash},
+          words_{blocks_ * block_words, device} {}
+
+    /// @brief Masks of the words of a block that the bits of an element are in.
+    static auto masks(const std::uint64_t hash_fns, const std::uint64_t* salts,
+                      const std::uint64_t h2) noexcept -> std::array<std::uint64_t, block_words> {
+        std::array<std::uint64_t, block_words> res{};
+        for (std::uint64_t idx = 0; idx < hash_fns; idx++) {
+            const auto bit = (h2 * salts[idx]) >> filter_type::block_shift;
+            res[bit / 64] |= std::uint64_t{1} << (bit % 64);
+        }
+        return res;
+    }
+
+    static void set(std::uint64_t* words, const std::size_t blocks, const std::uint64_t hash_fns,
+                    const std::uint64_t* salts, const std::uint64_t hash) noexcept {
+        const auto probes = bf::detail::Probes{hash};
+        auto* const block = words + Reducer::reduce(probes.h1, blocks) * block_words;
+        const auto mask = masks(hash_fns, salts, probes.h2);
+        for (std::size_t idx = 0; idx < block_words; idx++) {
+            if (mask[idx] != 0) {
+#pragma omp atomic update
+                block[idx] |= mask[idx];
+            }
+        }
+    }
+
+    static auto test(const std::uint64_t* words, const std::size_t blocks,
+                     const std::uint64_t hash_fns, const std::uint64_t* salts,
+                     const std::uint64_t hash) noexcept -> std::uint8_t {
+        const auto probes = bf::detail::Probes{hash};
+        const auto* const block = words + Reducer::reduce(probes.h1, blocks) * block_words;
+        const auto mask = masks(hash_fns, salts, probes.h2);
+        std::uint64_t miss = 0;
+        for (std::size_t idx = 0; idx < block_words; idx++) {
+            miss |= mask[idx] & ~block[idx];
+        }
+        return miss == 0;
+    }
+
+    std::size_t blocks_;
+    std::uint64_t hash_fns_;
+    [[no_unique_address]] Hasher hasher_;
+    detail::DeviceWords<std::uint64_t> words_;
+};
+
+/**
+ * @brief A split-block bloom filter in the memory of an offload device, with the bits of a
+ * `bf::SplitBlockBloomFilter` of the same parameters. Every key is handled by one device thread,
+ * which sets one bit in every word of its block with atomic ors, or tests them. Integer keys are
+ * hashed on the device with `Hasher`, which must be callable in a target region; keys of any other
+ * type can be hashed on the host and passed as hashes.
+ */
+template <typename Hasher = XXHash64>
+class SplitBlockBloomFilter {
+   public:
+    using filter_type = bf::SplitBlockBloomFilter<Hasher>;
+
+    /**
+     * @brief Creates a new split-block bloom filter on a device, with the number of blocks that
+     * the host filter would be created with.
+     * @param n An approximate number of elements to be inserted.
+     * @param eps False positive probability.
+     * @param hash Hash function.
+     * @param device Device number.
+     */
+    SplitBlockBloomFilter(const std::uint64_t elems, const arithmetic auto eps, Hasher hash = {},
+                          const int device = omp_get_default_device())
+        : SplitBlockBloomFilter{filter_type::blocks_for(elems, eps), hash, device} {}
+
+    /**
+     * @brief Copies a host filter to a device.
+     * @param filter Host filter.
+     * @param device Device number.
+     */
+    explicit SplitBlockBloomFilter(const filter_type& filter,
+                                   const int device = omp_get_default_device())
+        : SplitBlockBloomFilter{filter.blocks, filter.hasher, device} {
+        words_.upload(filter.words.data());
+    }
+
+    /// @brief Number of blocks.
+    [[nodiscard]] auto blocks() const noexcept -> std::size_t {
+        return blocks_;
+    }
+
+    /// @brief Device number.
+    [[nodiscard]] auto device() const noexcept -> int {
+        return words_.device();
+    }
+
+    /// @brief Device pointer to the words of the blocks, for kernels of the caller.
+    [[nodiscard]] auto data() const noexcept -> std::uint32_t* {
+        return words_.data();
+    }
+
+    /**
+     * @brief Inserts integer keys, which are hashed on the device.
+     * @param keys Keys on the host.
+     */
+    template <typename T>
+        requires std::is_integral_v<T> && hashable_with<T, Hasher>
+    void insert(const std::span<const T> keys) {
+        if (keys.empty()) {
+            return;
+        }
+        const auto* const ptr = keys.data();
+        const auto n = keys.size();
+        const auto hash = hasher_;
+        const auto* const salts = filter_type::salts.data();
+        auto* const words = words_.data();
+        const auto blocks = blocks_;
+#pragma omp target teams distribute parallel for device(words_.device()) is_device_ptr(words) \
+    map(to : ptr[0 : n], salts[0 : block_words]) firstprivate(hash)
+        for (std::size_t idx = 0; idx < n; idx++) {
+            set(words, blocks, salts, hash(ptr[idx]));
+        }
+    }
+
+    /**
+     * @brief Inserts elements which have already been hashed with `hasher` on the host.
+     * @param hashes Hashes of the elements.
+     */
+    void insert_hashes(const std::span<const std::uint64_t> hashes) {
+        if (hashes.empty()) {
+            return;
+        }
+        const auto* const ptr = hashes.data();
+        const auto n = hashes.size();
+        const auto* const salts = filter_type::salts.data();
+        auto* const words = words_.data();
+        const auto blocks = blocks_;
+#pragma omp target teams distribute parallel for device(words_.device()) is_device_ptr(words) \
+    map(to : ptr[0 : n], salts[0 : block_words])
+        for (std::size_t idx = 0; idx < n; idx++) {
+            set(words, blocks, salts, ptr[idx]);
+        }
+    }
+
+    /**
+     * @brief Checks if integer keys, which are hashed on the device, are likely to be in the bloom
+     * filter.
+     * @param keys Keys on the host.
+     * @param res Output, one byte per key which is one if the key was present and zero otherwise.
+     * @throws std::length_error If `res` is smaller than `keys`.
+     */
+    template <typename T>
+        requires std::is_integral_v<T> && hashable_with<T, Hasher>
+    void search(const std::span<const T> keys, const std::span<std::uint8_t> res) const {
+        detail::check_results(keys.size(), res.size());
+        if (keys.empty()) {
+            return;
+        }
+        const auto* const ptr = keys.data();
+        const auto n = keys.size();
+        auto* const out = res.data();
+        const auto hash = hasher_;
+        const auto* const salts = filter_type::salts.data();
+        const auto* const words = words_.data();
+        const auto blocks = blocks_;
+#pragma omp target teams distribute parallel for device(words_.device()) is_device_ptr(words) \
+    map(to : ptr[0 : n], salts[0 : block_words]) map(from : out[0 : n]) firstprivate(hash)
+        for (std::size_t idx = 0; idx < n; idx++) {
+            out[idx] = test(words, blocks, salts, hash(ptr[idx]));
+        }
+    }
+
+    /**
+     * @brief Checks if elements, which have already been hashed with `hasher` on the host, are
+     * likely to be in the bloom filter.
+     * @param hashes Hashes of the elements.
+     * @param res Output, one byte per element which is one if the element was present and zero
+     * otherwise.
+     * @throws std::length_error If `res` is smaller than `hashes`.
+     */
+    void search_hashes(const std::span<const std::uint64_t> hashes,
+                       const std::span<std::uint8_t> res) const {
+        detail::check_results(hashes.size(), res.size());
+        if (hashes.empty()) {
+            return;
+        }
+        const auto* const ptr = hashes.data();
+        const auto n = hashes.size();
+        auto* const out = res.data();
+        const auto* const salts = filter_type::salts.data();
+        const auto* const words = words_.data();
+        const auto blocks = blocks_;
+#pragma omp target teams distribute parallel for device(words_.device()) is_device_ptr(words) \
+    map(to : ptr[0 : n], salts[0 : block_words]) map(from : out[0 : n])
+        for (std::size_t idx = 0; idx < n; idx++) {
+            out[idx] = test(words, blocks, salts, ptr[idx]);
+        }
+    }
+
+    /**
+     * @brief Clears the bloom filter on the device.
+     */
+    void clear() noexcept {
+        words_.zero();
+    }
+
+    /**
+     * @brief Copies the bloom filter to the host.
+     * @return The host filter, with the same bits.
+     */
+    [[nodiscard]] auto to_host() const -> filter_type {
+        std::vector<std::uint32_t> words(words_.size());
+        words_.download(words.data());
+        return filter_type{std::as_bytes(std::span{words}), hasher_};
+    }
+
+    /**
+     * @brief Writes the bloom filter to a stream, in the format of
+     * `bf::SplitBlockBloomFilter::save`, through a copy on the host.
+     * @param os Output stream.
+     * @param compression Compression of the bit vector.
+     */
+    void save(std::ostream& os, const Compression compression = Compression::none) const {
+        to_host().save(os, compression);
+    }
+
+    /// @brief Hash function.
+    [[nodiscard]] auto hasher() const noexcept -> const Hasher& {
+        return hasher_;
+    }
+
+   private:
+    static constexpr auto block_words = filter_type::block_words;
+
+    SplitBlockBloomFilter(const std::size_t blocks, Hasher hash, const int device)
+        : blocks_{blocks}, hasher_{hash}, words_{blocks_ * block_words, device} {}
+
+    static void set(std::uint32_t* words, const std::size_t blocks, const std::uint32_t* salts,
+                    const std::uint64_t hash) noexcept {
+        auto* const block = words + filter_type::index(hash, blocks) * block_words;
+        const auto key = static_cast<std::uint32_t>(hash);
+        for (std::size_t idx = 0; idx < block_words; idx++) {
+#pragma omp atomic update
+            block[idx] |= std::uint32_t{1} << ((key * salts[idx]) >> 27);
+        }
+    }
+
+    static auto test(const std::uint32_t* words, const std::size_t blocks,
+                     const std::uint32_t* salts, const std::uint64_t hash) noexcept
+        -> std::uint8_t {
+        const auto* const block = words + filter_type::index(hash, blocks) * block_words;
+        const auto key = static_cast<std::uint32_t>(hash);
+        std::uint32_t miss = 0;
+        for (std::size_t idx = 0; idx < block_words; idx++) {
+            miss |= ~block[idx] & (std::uint32_t{1} << ((key * salts[idx]) >> 27));
+        }
+        return miss == 0;
+    }
+
+    std::size_t blocks_;
+    [[no_unique_address]] Hasher hasher_;
+    detail::DeviceWords<std::uint32_t> words_;
+};
+
+}  // namespace bf::gpu
+
+#endif
@@ -0,0 +1,175 @@
+/**
+ * @brief Runs the `bf` command-line tool on small inputs and checks its output. Filters are built
+ * from newline-delimited and length-prefixed keys, from files and from the standard input, and
+ * queried in every output mode; the inputs cover empty keys, a missing trailing newline, a key
+ * which spans the boundary between two chunks, and a truncated length-prefixed key, which must
+ * fail. The program exits with a non-zero status if any of the checks fail, so that it can be run
+ * as a test.
+ *
+ * Usage: cli_tests BF
+ */
+
+#include <sys/wait.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+// Number of bytes which the tool reads at a time.
+constexpr std::size_t chunk_bytes = std::size_t{16} << 20;
+
+auto ok = true;
+
+void expect(const bool cond, const std::string& what) {
+    if (!cond) {
+        std::cerr << "FAIL: " << what << '\n';
+        ok = false;
+    }
+}
+
+/// @brief Output and exit status of a command.
+struct Run {
+    int status;
+    std::string out;
+};
+
+/// @brief Runs a shell command and captures its standard output.
+auto run(const std::string& cmd) -> Run {
+    auto* const pipe = ::popen(cmd.c_str(), "r");
+    if (pipe == nullptr) {
+        return {-1, {}};
+    }
+    auto res = Run{};
+    char buf[4096];
+    for (auto len = std::fread(buf, 1, sizeof(buf), pipe); len != 0;
+         len = std::fread(buf, 1, sizeof(buf), pipe)) {
+        res.out.append(buf, len);
+    }
+    const auto status = ::pclose(pipe);
+    res.status = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    return res;
+}
+
+void write_file(const std::filesystem::path& path, const std::string_view bytes) {
+    auto file = std::ofstream{path, std::ios::binary};
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+auto read_file(const std::filesystem::path& path) -> std::string {
+    auto file = std::ifstream{path, std::ios::binary};
+    return {std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+}
+
+/// @brief Frames keys with a 4-byte little-endian length.
+auto framed(const std::vector<std::string>& keys) -> std::string {
+    std::string res;
+    for (const auto& key : keys) {
+        const auto len = static_cast<std::uint32_t>(key.size());
+        for (int shift = 0; shift < 32; shift += 8) {
+            res.push_back(static_cast<char>((len >> shift) & 0xff));
+        }
+        res += key;
+    }
+    return res;
+}
+
+auto quote(const std::filesystem::path& path) -> std::string {
+    return "'" + path.string() + "'";
+}
+
+}  // namespace
+
+auto main(int argc, char** argv) -> int {
+    if (argc != 2) {
+        std::cerr << "Usage: cli_tests BF\n";
+        return EXIT_FAILURE;
+    }
+    const auto bf = "'" + std::string{argv[1]} + "'";
+    const auto dir = std::filesystem::temp_directory_path() / "bf_cli_tests";
+    std::filesystem::create_directories(dir);
+    const auto filter = quote(dir / "filter.bf");
+
+    // Newline-delimited keys, with an empty key and without a trailing newline.
+    write_file(dir / "keys.txt", "alpha\nbeta\n\ngamma");
+    expect(run(bf + " build -o " + filter + " --eps 1e-6 " + quote(dir / "keys.txt")).status == 0,
+           "build from newline-delimited keys");
+    expect(run(bf + " query " + filter + " " + quote(dir / "keys.txt")).out == "1\n1\n1\n1\n",
+           "one result per line, including the empty and the last line");
+    write_file(dir / "probes.txt", "alpha\ndelta\n\nepsilon\ngamma\n");
+    expect(run(bf + " query " + filter + " " + quote(dir / "probes.txt")).out ==
+               "1\n0\n1\n0\n1\n",
+           "results line up with the probes");
+    expect(run(bf + " query " + filter + " --matches " + quote(dir / "probes.txt")).out ==
+               "alpha\n\ngamma\n",
+           "--matches prints the keys which were found");
+    expect(run(bf + " query " + filter + " --count " + quote(dir / "probes.txt")).out == "3 5\n",
+           "--count prints the number of positives and of keys");
+
+    // The same keys from the standard input, whose hashes are kept until the end of the input.
+    const auto piped = quote(dir / "piped.bf");
+    expect(run("cat " + quote(dir / "keys.txt") + " | " + bf + " build -o " + piped +
+               " --eps 1e-6")
+                   .status == 0,
+           "build from the standard input");
+    expect(read_file(dir / "piped.bf") == read_file(dir / "filter.bf"),
+           "the standard input builds the same filter as a file");
+
+    // Length-prefixed keys, which may contain newlines.
+    const auto keys = std::vector<std::string>{"one", "", "two\nlines", "three"};
+    write_file(dir / "keys.bin", framed(keys));
+    expect(run(bf + " build -o " + filter + " --eps 1e-6 --length " + quote(dir / "keys.bin"))
+                   .status == 0,
+           "build from length-prefixed keys");
+    write_file(dir / "probes.bin", framed({"two\nlines", "two", "", "four"}));
+    expect(run(bf + " query " + filter + " --length " + quote(dir / "probes.bin")).out ==
+               "1\n0\n1\n0\n",
+           "length-prefixed keys are searched whole");
+
+    // A truncated length-prefixed key fails both commands.
+    auto truncated = framed({"whole"});
+    truncated += framed({"truncated"}).substr(0, 7);
+    write_file(dir / "truncated.bin", truncated);
+    expect(run(bf + " build -o " + filter + " --length " + quote(dir / "truncated.bin") +
+               " 2>/dev/null")
+                   .status != 0,
+           "build fails on a truncated key");
+    expect(run(bf + " query " + filter + " --length " + quote(dir / "truncated.bin") +
+               " 2>/dev/null")
+                   .status != 0,
+           "query fails on a truncated key");
+
+    // A key which starts in the first chunk and ends in the second.
+    std::string big;
+    std::uint64_t lines = 0;
+    while (big.size() + 16 < chunk_bytes) {
+        big += std::to_string(lines++) + '\n';
+    }
+    const auto spanning = std::string(32, 's');
+    big += spanning + '\n';
+    lines++;
+    big += "last\n";
+    lines++;
+    write_file(dir / "big.txt", big);
+    write_file(dir / "spanning.txt", spanning + '\n' + spanning.substr(0, 16) + '\n');
+    expect(run(bf + " build -o " + filter + " --eps 1e-6 " + quote(dir / "big.txt")).status == 0,
+           "build from more than one chunk");
+    expect(run(bf + " query " + filter + " --matches " + quote(dir / "spanning.txt")).out ==
+               spanning + '\n',
+           "a key which spans two chunks is inserted whole");
+    expect(run(bf + " query " + filter + " --count " + quote(dir / "big.txt")).out ==
+               std::to_string(lines) + ' ' + std::to_string(lines) + '\n',
+           "every key of a multi-chunk input is found");
+
+    std::filesystem::remove_all(dir);
+    std::cout << (ok ? "All command-line checks passed.\n" : "Some command-line checks failed.\n");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
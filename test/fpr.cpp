@@ -0,0 +1,142 @@
+/**
+ * @brief Measures the false positive rate of the filters and compares it with the theoretical one.
+ * For every filter and `(elems, eps)` point, the filter is built from `elems` random keys and
+ * probed with keys that were not inserted. The report lists the measured and the theoretical false
+ * positive rates, the number of bits per key, and the time per insertion and lookup. The program
+ * exits with a non-zero status when a measured rate exceeds the theoretical one by more than the
+ * sampling error allows, so that it can be run as a test.
+ *
+ * Usage: fpr [--probes N]
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../include/bf.hpp"
+
+namespace {
+
+struct Point {
+    std::uint64_t elems;
+    double eps;
+};
+
+struct Result {
+    double measured;
+    double theoretical;
+    double bits_per_key;
+    double insert_ns;
+    double search_ns;
+};
+
+/// @brief Theoretical false positive rate of a standard bloom filter with the given parameters.
+auto standard_fpr(const std::uint64_t elems, const std::size_t bits, const std::uint64_t hash_fns) {
+    const auto fill = -std::expm1(static_cast<double>(hash_fns * elems) *
+                                  std::log1p(-1.0 / static_cast<double>(bits)));
+    return std::pow(fill, static_cast<double>(hash_fns));
+}
+
+template <typename Filter>
+auto theoretical(const Filter& filter, const std::uint64_t elems) {
+    if constexpr (requires { filter.blocks; }) {
+        return Filter::fpr(elems, filter.blocks, filter.hash_fns);
+    } else {
+        return standard_fpr(elems, filter.bits, filter.hash_fns);
+    }
+}
+
+template <typename Filter>
+auto measure(const Point point, const std::uint64_t probes) -> Result {
+    using clock = std::chrono::steady_clock;
+
+    // Inserted keys are even and probed keys are odd, so that the two sets are disjoint.
+    auto gen = std::mt19937_64{point.elems};
+    auto filter = Filter{point.elems, point.eps};
+
+    const auto inserted = clock::now();
+    for (std::uint64_t idx = 0; idx < point.elems; idx++) {
+        filter.insert(gen() << 1);
+    }
+    const auto searched = clock::now();
+    std::uint64_t positives = 0;
+    for (std::uint64_t idx = 0; idx < probes; idx++) {
+        positives += static_cast<std::uint64_t>(filter.search((gen() << 1) | 1));
+    }
+    const auto done = clock::now();
+
+    const auto ns = [](const auto begin, const auto end, const std::uint64_t ops) {
+        return std::chrono::duration<double, std::nano>(end - begin).count() /
+               static_cast<double>(ops);
+    };
+    return {
+        static_cast<double>(positives) / static_cast<double>(probes),
+        theoretical(filter, point.elems),
+        static_cast<double>(filter.bits) / static_cast<double>(point.elems),
+        ns(inserted, searched, point.elems),
+        ns(searched, done, probes),
+    };
+}
+
+/**
+ * @brief Measures a filter at all of the points and prints a row per point.
+ * @return Whether all of the measured rates were within the bound.
+ */
+template <typename Filter>
+auto report(const std::string_view name, const std::uint64_t probes) -> bool {
+    constexpr std::array points = {Point{10'000, 1e-2}, Point{100'000, 1e-3},
+                                   Point{1'000'000, 1e-2}, Point{1'000'000, 1e-4}};
+
+    auto ok = true;
+    for (const auto point : points) {
+        const auto res = measure<Filter>(point, probes);
+        // Five standard deviations of the sampling error, on top of a relative slack for the
+        // deviation of double hashing from independent hash functions.
+        const auto sigma = std::sqrt(res.theoretical * (1 - res.theoretical) / probes);
+        const auto pass = res.measured <= 1.1 * res.theoretical + 5 * sigma;
+        ok = ok && pass;
+
+        std::cout << std::left << std::setw(26) << name << std::right << std::setw(9)
+                  << point.elems << std::setw(9) << point.eps << std::setw(13) << res.measured
+                  << std::setw(13) << res.theoretical << std::setw(10) << std::fixed
+                  << std::setprecision(2) << res.bits_per_key << std::setw(11) << res.insert_ns
+                  << std::setw(11) << res.search_ns << std::defaultfloat << std::setprecision(6)
+                  << (pass ? "" : "  FAIL") << '\n';
+    }
+    return ok;
+}
+
+}  // namespace
+
+auto main(int argc, char** argv) -> int {
+    std::uint64_t probes = 1'000'000;
+    for (auto idx = 1; idx < argc; idx++) {
+        if (std::string_view{argv[idx]} == "--probes" && idx + 1 < argc) {
+            probes = std::stoull(argv[++idx]);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--probes N]\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::cout << std::left << std::setw(26) << "filter" << std::right << std::setw(9) << "elems"
+              << std::setw(9) << "eps" << std::setw(13) << "measured" << std::setw(13)
+              << "theoretical" << std::setw(10) << "bits/key" << std::setw(11) << "insert ns"
+              << std::setw(11) << "search ns" << '\n';
+
+    auto ok = true;
+    ok = report<bf::BloomFilter<>>("BloomFilter", probes) && ok;
+    ok = report<bf::BloomFilter<bf::DefaultHasher, bf::PowerOfTwo>>("BloomFilter<PowerOfTwo>",
+                                                                     probes) &&
+         ok;
+    ok = report<bf::BlockedBloomFilter<>>("BlockedBloomFilter", probes) && ok;
+    ok = report<bf::RegisterBlockedBloomFilter<>>("RegisterBlockedBloomFilter", probes) && ok;
+    ok = report<bf::ConcurrentBloomFilter<>>("ConcurrentBloomFilter", probes) && ok;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
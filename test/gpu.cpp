@@ -0,0 +1,150 @@
+/**
+ * @brief Checks the device filters of `bf_gpu.hpp` against the host filters. Both are built from
+ * the same keys, once hashed on the device and once hashed on the host, and must save the same
+ * bytes; a host filter copied to the device must answer every probe as the host filter does, and a
+ * device filter must be memory-mappable on the host. The program reports whether the kernels ran
+ * on an offload device or on the host, and exits with a non-zero status if any of the checks fail,
+ * so that it can be run as a test.
+ *
+ * Usage: gpu_tests
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <span>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../include/bf_gpu.hpp"
+
+namespace {
+
+auto ok = true;
+
+void expect(const bool cond, const std::string& what) {
+    if (!cond) {
+        std::cerr << "FAIL: " << what << '\n';
+        ok = false;
+    }
+}
+
+template <typename Filter>
+auto saved(const Filter& filter) -> std::string {
+    std::ostringstream os;
+    filter.save(os);
+    return os.str();
+}
+
+template <typename Filter>
+auto hashes_of(const Filter& filter, const std::vector<std::uint64_t>& keys)
+    -> std::vector<std::uint64_t> {
+    std::vector<std::uint64_t> res;
+    res.reserve(keys.size());
+    for (const auto key : keys) {
+        res.push_back(filter.hasher(key));
+    }
+    return res;
+}
+
+/**
+ * @brief Checks a device filter type against its host filter type.
+ * @param name Name of the filter in the messages.
+ * @param make Creates an empty device filter.
+ * @param keys Inserted keys.
+ * @param probes Keys which were not inserted.
+ * @param path File which the device filter is saved to and memory-mapped from.
+ */
+template <typename Mapped, typename Make>
+void check(const std::string& name, const Make& make, const std::vector<std::uint64_t>& keys,
+           const std::vector<std::uint64_t>& probes, const std::filesystem::path& path) {
+    using device_type = decltype(make());
+
+    auto device = make();
+    device.insert(std::span<const std::uint64_t>{keys});
+    auto host = device.to_host();
+    host.clear();
+    host.insert_many(keys);
+    expect(saved(device) == saved(host), name + ": keys hashed on the device set the host bits");
+
+    auto hashed = make();
+    hashed.insert_hashes(hashes_of(host, keys));
+    expect(saved(hashed) == saved(host), name + ": hashes from the host set the host bits");
+
+    std::vector<std::uint64_t> all = keys;
+    all.insert(all.end(), probes.begin(), probes.end());
+    const auto copied = device_type{host};
+    std::vector<std::uint8_t> found(all.size());
+    copied.search(std::span<const std::uint64_t>{all}, found);
+    std::vector<std::uint8_t> found_hashes(all.size());
+    copied.search_hashes(hashes_of(host, all), found_hashes);
+    auto same = true;
+    for (std::size_t idx = 0; idx < all.size(); idx++) {
+        same = same && found[idx] == host.search(all[idx]) && found_hashes[idx] == found[idx];
+    }
+    expect(same, name + ": a copy of the host filter answers as the host filter");
+    auto inserted = true;
+    for (std::size_t idx = 0; idx < keys.size(); idx++) {
+        inserted = inserted && found[idx] == 1;
+    }
+    expect(inserted, name + ": every inserted key is found");
+
+    {
+        std::ofstream os{path, std::ios::binary};
+        device.save(os);
+    }
+    const auto mapped = Mapped{path.string(), false, host.hasher};
+    auto mapped_same = true;
+    for (std::size_t idx = 0; idx < all.size(); idx++) {
+        mapped_same = mapped_same && mapped.search(all[idx]) == (found[idx] == 1);
+    }
+    expect(mapped_same, name + ": the saved device filter is memory-mappable on the host");
+
+    device.clear();
+    expect(saved(device) == saved(make()), name + ": clear empties the device filter");
+}
+
+}  // namespace
+
+auto main() -> int {
+    auto on_device = false;
+#pragma omp target map(from : on_device)
+    on_device = !omp_is_initial_device();
+    std::cout << (on_device ? "Running on an offload device.\n"
+                            : "No offload device, running on the host.\n");
+
+    auto rng = std::mt19937_64{42};
+    std::vector<std::uint64_t> keys(100000);
+    for (auto& key : keys) {
+        key = rng();
+    }
+    std::vector<std::uint64_t> probes(100000);
+    for (auto& probe : probes) {
+        probe = rng();
+    }
+    const auto dir = std::filesystem::temp_directory_path() / "bf_gpu_tests";
+    std::filesystem::create_directories(dir);
+
+    check<bf::MappedBlockedBloomFilter<>>(
+        "blocked", [] { return bf::gpu::BlockedBloomFilter<>{100000, 1e-3}; }, keys, probes,
+        dir / "blocked.bf");
+    check<bf::MappedBlockedBloomFilter<bf::DefaultHasher, bf::PowerOfTwo>>(
+        "blocked, power of two",
+        [] { return bf::gpu::BlockedBloomFilter<bf::DefaultHasher, bf::PowerOfTwo>{100000, 1e-3}; },
+        keys, probes, dir / "pow2.bf");
+    check<bf::MappedSplitBlockBloomFilter<>>(
+        "split-block", [] { return bf::gpu::SplitBlockBloomFilter<>{100000, 1e-3}; }, keys, probes,
+        dir / "split_block.bf");
+    check<bf::MappedSplitBlockBloomFilter<bf::XXHash64>>(
+        "split-block, seeded",
+        [] { return bf::gpu::SplitBlockBloomFilter<>{100000, 1e-3, bf::XXHash64{7}}; }, keys,
+        probes, dir / "seeded.bf");
+
+    std::filesystem::remove_all(dir);
+    std::cout << (ok ? "All device checks passed.\n" : "Some device checks failed.\n");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -1,5 +1,13 @@
 #include <catch2/catch_all.hpp>
 
+#include <filesystem>
+#include <fstream>
+#include <memory_resource>
+#include <numeric>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
 #include "../include/bf.hpp"
 
 TEST_CASE("Insert and search strings", "[insert][search][string]") {
@@ -119,3 +127,1143 @@ TEST_CASE("Insert many and search many", "[insert_many][search_many][int]") {
         REQUIRE(val);
     }
 }
+
+TEST_CASE("Blocked insert and search", "[blocked][insert][search][string]") {
+    auto bf = bf::BlockedBloomFilter{6, 1e-2};
+
+    REQUIRE(bf.bits % bf::BlockedBloomFilter<>::block_bits == 0);
+    REQUIRE(bf::BlockedBloomFilter<>::fpr(6, bf.blocks, bf.hash_fns) <= 1e-2);
+
+    auto words = std::vector<std::string>{"", "hello", "world", "I", "am", "here"};
+    bf.insert_many(words);
+    for (const auto& word : words) {
+        REQUIRE(bf.search(word));
+    }
+
+    bf.clear();
+
+    for (const auto& val : bf.search_many(words)) {
+        REQUIRE(!val);
+    }
+}
+
+TEST_CASE("Blocked sizing accounts for blocking", "[blocked][constructor]") {
+    const auto elems = 1'000'000;
+    const auto eps = 1e-3;
+    auto bf = bf::BlockedBloomFilter{elems, eps};
+    auto standard = bf::BloomFilter{elems, eps};
+
+    REQUIRE(bf.bits >= standard.bits);
+    REQUIRE(bf::BlockedBloomFilter<>::fpr(elems, bf.blocks, bf.hash_fns) <= eps);
+    REQUIRE_THROWS_AS(bf::BlockedBloomFilter(0, eps), std::domain_error);
+    REQUIRE_THROWS_AS(bf::BlockedBloomFilter(elems, 0.0), std::domain_error);
+    REQUIRE_THROWS_AS(bf::BloomFilter(elems, 0.0), std::domain_error);
+    REQUIRE_THROWS_AS(bf::BloomFilter(elems, 1.0), std::domain_error);
+}
+
+TEST_CASE("Bit array storage", "[bitarray]") {
+    auto bits = bf::BitArray{1000};
+
+    REQUIRE(bits.size() == 1000);
+    REQUIRE(bits.words() % bf::BitArray::line_words == 0);
+    REQUIRE(bits.words() * bf::BitArray::word_bits >= bits.size());
+    REQUIRE(reinterpret_cast<std::uintptr_t>(bits.data()) % bf::BitArray::alignment == 0);
+
+    bits.set(0);
+    bits.set(63);
+    bits.set(64);
+    bits.set(999);
+
+    REQUIRE(bits.test(0));
+    REQUIRE(bits[63]);
+    REQUIRE(bits[64]);
+    REQUIRE(bits[999]);
+    REQUIRE(!bits[1]);
+    REQUIRE(!bits[998]);
+    REQUIRE(bits.data()[0] == (std::uint64_t{1} | std::uint64_t{1} << 63));
+    REQUIRE(bits.data()[1] == 1);
+}
+
+TEST_CASE("False positive rate matches the requested one", "[fpr][int]") {
+    const auto elems = 10'000;
+    const auto eps = 1e-2;
+    auto bf = bf::BloomFilter{elems, eps};
+
+    for (auto num = 0; num < elems; num++) {
+        bf.insert(num);
+    }
+
+    auto positives = 0;
+    const auto probes = 100'000;
+    for (auto num = elems; num < elems + probes; num++) {
+        positives += static_cast<int>(bf.search(num));
+    }
+    REQUIRE(static_cast<double>(positives) / probes < 1.5 * eps);
+}
+
+TEST_CASE("Strings are hashed by their contents", "[hasher][string]") {
+    auto bf = bf::BloomFilter{4, 1e-3};
+    char buffer[] = "hello";
+
+    bf.insert(static_cast<const char*>(buffer));
+
+    REQUIRE(bf.search("hello"));
+    REQUIRE(bf.search(std::string{"hello"}));
+    REQUIRE(bf.search(std::string_view{"hello"}));
+    REQUIRE(bf::DefaultHasher{}(buffer) == bf::WyHash{}(std::string_view{"hello"}));
+    REQUIRE(bf::WyHash{}(std::string_view{"hello"}) != bf::WyHash{1}(std::string_view{"hello"}));
+    REQUIRE(bf::IntegerMixer{}(1) != bf::IntegerMixer{}(2));
+}
+
+TEST_CASE("Custom hasher policy", "[hasher][int]") {
+    struct Mixer {
+        [[nodiscard]] constexpr auto operator()(const std::uint64_t data) const noexcept {
+            return bf::IntegerMixer{}(data);
+        }
+    };
+
+    auto bf = bf::BloomFilter<Mixer>{8, 1e-2};
+    auto blocked = bf::BlockedBloomFilter{8, 1e-2, bf::IntegerMixer{}};
+    auto nums = {1, 2, 3, 5, 8, 13, 21, 34};
+
+    bf.insert_many(nums);
+    blocked.insert_many(nums);
+    for (const auto& num : nums) {
+        REQUIRE(bf.search(num));
+        REQUIRE(blocked.search(num));
+    }
+}
+
+TEST_CASE("Power-of-two range reduction", "[reducer][int]") {
+    auto bf = bf::BloomFilter<bf::DefaultHasher, bf::PowerOfTwo>{1000, 1e-2};
+    auto blocked = bf::BlockedBloomFilter<bf::DefaultHasher, bf::PowerOfTwo>{1000, 1e-2};
+
+    REQUIRE(std::has_single_bit(bf.bits));
+    REQUIRE(std::has_single_bit(blocked.blocks));
+
+    for (auto num = 0; num < 1000; num++) {
+        bf.insert(num);
+        blocked.insert(num);
+    }
+    for (auto num = 0; num < 1000; num++) {
+        REQUIRE(bf.search(num));
+        REQUIRE(blocked.search(num));
+    }
+    REQUIRE(bf::FastRange::reduce(~std::uint64_t{0}, 10) == 9);
+    REQUIRE(bf::FastRange::reduce(0, 10) == 0);
+}
+
+TEMPLATE_TEST_CASE("Batched search matches search", "[search_many][simd][int]", bf::FastRange,
+                   bf::PowerOfTwo) {
+    auto bf = bf::BloomFilter<bf::DefaultHasher, TestType>{500, 1e-2};
+    auto nums = std::vector<int>(2000);
+    std::iota(nums.begin(), nums.end(), 0);
+
+    bf.insert_many(std::views::take(nums, 500));
+
+    auto res = std::vector<std::uint8_t>(nums.size());
+    bf.search_many(nums, res);
+    const auto vals = bf.search_many(nums);
+    for (std::size_t idx = 0; idx < nums.size(); idx++) {
+        REQUIRE(res[idx] == static_cast<std::uint8_t>(bf.search(nums[idx])));
+        REQUIRE(vals[idx] == bf.search(nums[idx]));
+    }
+
+    auto small = std::vector<std::uint8_t>(nums.size() - 1);
+    REQUIRE_THROWS_AS(bf.search_many(nums, small), std::length_error);
+
+#if defined(BF_HAS_X86_SIMD)
+    auto probes = std::vector<bf::detail::Probes>{};
+    for (const auto& num : nums) {
+        probes.emplace_back(bf.hasher(num));
+    }
+    auto scalar = std::vector<std::uint8_t>(nums.size());
+    bf::detail::search_batch_scalar<TestType>(bf.bvec.data(), bf.bits, bf.hash_fns, probes.data(),
+                                              probes.size(), scalar.data());
+    REQUIRE(scalar == res);
+    if (bf::simd() >= bf::Simd::avx2) {
+        auto avx2 = std::vector<std::uint8_t>(nums.size());
+        bf::detail::search_batch_avx2<TestType>(bf.bvec.data(), bf.bits, bf.hash_fns,
+                                                probes.data(), probes.size(), avx2.data());
+        REQUIRE(avx2 == scalar);
+    }
+#endif
+}
+
+TEST_CASE("Prefetched insert many and search many", "[insert_many][search_many][prefetch]") {
+    auto bf = bf::BloomFilter{1000, 1e-2};
+    auto blocked = bf::BlockedBloomFilter{1000, 1e-2};
+    auto nums = std::vector<int>(3000);
+    std::iota(nums.begin(), nums.end(), 0);
+    const auto inserted = std::views::take(nums, 1000);
+
+    for (const auto window : {0, 1, 5, 16}) {
+        bf.clear();
+        blocked.clear();
+        bf.insert_many(inserted, window);
+        blocked.insert_many(inserted, window);
+
+        auto res = std::vector<std::uint8_t>(nums.size());
+        auto res_blocked = std::vector<std::uint8_t>(nums.size());
+        bf.search_many(nums, res, window);
+        blocked.search_many(nums, res_blocked, window);
+        for (std::size_t idx = 0; idx < nums.size(); idx++) {
+            REQUIRE(res[idx] == static_cast<std::uint8_t>(bf.search(nums[idx])));
+            REQUIRE(res_blocked[idx] == static_cast<std::uint8_t>(blocked.search(nums[idx])));
+        }
+        for (const auto& num : inserted) {
+            REQUIRE(bf.search(num));
+            REQUIRE(blocked.search(num));
+        }
+    }
+}
+
+TEST_CASE("Concurrent insert and search", "[concurrent][insert][search][int]") {
+    const auto threads = 8;
+    const auto per_thread = 10'000;
+    auto bf = bf::ConcurrentBloomFilter{threads * per_thread, 1e-3};
+
+    auto workers = std::vector<std::thread>{};
+    for (auto thread = 0; thread < threads; thread++) {
+        workers.emplace_back([&bf, thread] {
+            for (auto num = thread * per_thread; num < (thread + 1) * per_thread; num++) {
+                bf.insert(num);
+                static_cast<void>(bf.search(num + 1));
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    for (auto num = 0; num < threads * per_thread; num++) {
+        REQUIRE(bf.search(num));
+    }
+
+    bf.clear();
+    REQUIRE(!bf.search(0));
+}
+
+TEST_CASE("Parallel insert many and search many", "[insert_many][search_many][parallel][int]") {
+    auto pool = bf::ThreadPool{4};
+    auto bf = bf::BloomFilter{50'000, 1e-3};
+    auto sequential = bf::BloomFilter{50'000, 1e-3};
+    auto nums = std::vector<int>(100'000);
+    std::iota(nums.begin(), nums.end(), 0);
+    const auto inserted = std::span{nums}.first(50'000);
+
+    bf.insert_many(pool, inserted);
+    sequential.insert_many(inserted);
+    REQUIRE(std::equal(bf.bvec.data(), bf.bvec.data() + bf.bvec.words(), sequential.bvec.data()));
+
+    auto hashed = bf::BloomFilter{50'000, 1e-3};
+    auto hashes = std::vector<std::uint64_t>(inserted.size());
+    std::ranges::transform(inserted, hashes.begin(), hashed.hasher);
+    hashed.insert_hashes(pool, hashes);
+    REQUIRE(std::equal(hashed.bvec.data(), hashed.bvec.data() + hashed.bvec.words(),
+                       sequential.bvec.data()));
+
+    auto res = std::vector<std::uint8_t>(nums.size());
+    auto expected = std::vector<std::uint8_t>(nums.size());
+    bf.search_many(pool, nums, res);
+    sequential.search_many(nums, expected);
+    REQUIRE(res == expected);
+
+    auto small = std::vector<std::uint8_t>(nums.size() - 1);
+    REQUIRE_THROWS_AS(bf.search_many(pool, nums, small), std::length_error);
+    REQUIRE_THROWS_AS(pool.parallel_for(10, [](auto, auto) { throw std::runtime_error{"fail"}; }),
+                      std::runtime_error);
+}
+
+TEST_CASE("Save, load, and map", "[serialization][mmap][string]") {
+    auto bf = bf::BloomFilter{100, 1e-2};
+    auto words = std::vector<std::string>{"afopsiv", "coxpz", "pqeacxnvzm", "zm", "acxk"};
+    bf.insert_many(words);
+
+    auto stream = std::stringstream{};
+    bf.save(stream);
+    auto loaded = decltype(bf)::load(stream);
+
+    REQUIRE(loaded.bits == bf.bits);
+    REQUIRE(loaded.hash_fns == bf.hash_fns);
+    REQUIRE(std::equal(bf.bvec.data(), bf.bvec.data() + bf.bvec.words(), loaded.bvec.data()));
+    for (const auto& word : words) {
+        REQUIRE(loaded.search(word));
+    }
+
+    auto other = std::stringstream{stream.str()};
+    REQUIRE_THROWS_AS((bf::BloomFilter<bf::DefaultHasher, bf::PowerOfTwo>::load(other)),
+                      std::runtime_error);
+    auto corrupt = stream.str();
+    corrupt.back() ^= 1;
+    auto corrupted = std::stringstream{corrupt};
+    REQUIRE_THROWS_AS(decltype(bf)::load(corrupted), std::runtime_error);
+
+    // A number of bits whose number of words wraps around to zero.
+    const auto header_bytes = [](const std::uint64_t bits, const std::uint64_t count) {
+        auto header = bf::detail::Header{};
+        header.layout = bf::detail::Layout::standard;
+        header.bits = bits;
+        header.hash_fns = 1;
+        header.words = count;
+        header.hasher = bf::DefaultHasher::id;
+        header.reducer = bf::FastRange::id;
+        return std::string{reinterpret_cast<const char*>(&header), sizeof(header)};
+    };
+    const auto wrapped = header_bytes(std::numeric_limits<std::uint64_t>::max(), 0);
+    REQUIRE(bf::BitArray::words_for(std::numeric_limits<std::uint64_t>::max()) == 0);
+    auto wrapped_stream = std::stringstream{wrapped};
+    REQUIRE_THROWS_AS(decltype(bf)::load(wrapped_stream), std::runtime_error);
+
+    auto seeded = bf::BloomFilter<bf::WyHash>{100, 1e-2, bf::WyHash{42}};
+    seeded.insert_many(words);
+    auto seeded_stream = std::stringstream{};
+    seeded.save(seeded_stream);
+    auto unseeded = std::stringstream{seeded_stream.str()};
+    REQUIRE_THROWS_AS(bf::BloomFilter<bf::WyHash>::load(unseeded), std::runtime_error);
+    const auto reseeded = bf::BloomFilter<bf::WyHash>::load(seeded_stream, bf::WyHash{42});
+    for (const auto& word : words) {
+        REQUIRE(reseeded.search(word));
+    }
+
+#if defined(BF_HAS_MMAP)
+    const auto path = (std::filesystem::temp_directory_path() / "bf_tests.bloom").string();
+    {
+        auto file = std::ofstream{path, std::ios::binary};
+        bf.save(file);
+    }
+    const auto mapped = bf::MappedBloomFilter{path, true};
+    REQUIRE(mapped.bits() == bf.bits);
+    REQUIRE(mapped.hash_fns() == bf.hash_fns);
+    for (const auto& word : words) {
+        REQUIRE(mapped.search(word));
+    }
+    auto res = std::vector<std::uint8_t>(words.size());
+    mapped.search_many(words, res);
+    REQUIRE(std::ranges::all_of(res, [](const auto val) { return val == 1; }));
+    REQUIRE(mapped.search_many(words) == bf.search_many(words));
+    {
+        auto file = std::ofstream{path, std::ios::binary};
+        seeded.save(file);
+    }
+    REQUIRE_THROWS_AS(bf::MappedBloomFilter<bf::WyHash>{path}, std::runtime_error);
+    REQUIRE(bf::MappedBloomFilter<bf::WyHash>{path, true, bf::WyHash{42}}.search(words[0]));
+    // Headers whose bits do not fit in the file, or whose number of words wraps around.
+    constexpr auto huge = std::uint64_t{1} << 60;
+    for (const auto& bytes : {wrapped, header_bytes(huge, bf::BitArray::words_for(huge))}) {
+        {
+            auto file = std::ofstream{path, std::ios::binary};
+            file << bytes;
+        }
+        REQUIRE_THROWS_AS(bf::MappedBloomFilter{path}, std::runtime_error);
+    }
+    std::filesystem::remove(path);
+    REQUIRE_THROWS_AS(bf::MappedBloomFilter{path}, std::system_error);
+#endif
+}
+
+TEST_CASE("Compressed save and load", "[serialization][compression]") {
+    using filter = bf::BloomFilter<>;
+    const auto raw_size = [](const filter& bf) {
+        return sizeof(bf::detail::Header) + bf.bvec.words() * sizeof(std::uint64_t);
+    };
+    const auto round_trip = [](const filter& bf, const bf::Compression compression) {
+        auto stream = std::stringstream{};
+        bf.save(stream, compression);
+        const auto size = stream.str().size();
+        const auto loaded = filter::load(stream);
+        REQUIRE(loaded.bits == bf.bits);
+        REQUIRE(loaded.hash_fns == bf.hash_fns);
+        REQUIRE(std::equal(bf.bvec.data(), bf.bvec.data() + bf.bvec.words(), loaded.bvec.data()));
+        return size;
+    };
+
+    // An over-provisioned filter is mostly zero, and its code is much smaller.
+    auto sparse = filter{1'000'000, 1e-2};
+    REQUIRE(round_trip(sparse, bf::Compression::automatic) < 64 + raw_size(sparse) / 1000);
+    sparse.insert_many(std::views::iota(0, 10'000));
+    const auto sparse_size = round_trip(sparse, bf::Compression::automatic);
+    REQUIRE(sparse_size < raw_size(sparse) / 5);
+    REQUIRE(round_trip(sparse, bf::Compression::elias_fano) == sparse_size);
+    REQUIRE(round_trip(sparse, bf::Compression::none) == raw_size(sparse));
+
+    // A full filter is kept as is, unless the code is asked for.
+    auto full = filter{10'000, 1e-2};
+    full.insert_many(std::views::iota(0, 10'000));
+    REQUIRE(round_trip(full, bf::Compression::automatic) == raw_size(full));
+    REQUIRE(round_trip(full, bf::Compression::elias_fano) > raw_size(full));
+
+    auto stream = std::stringstream{};
+    sparse.save(stream, bf::Compression::elias_fano);
+    for (const auto offset : {std::size_t{64}, std::size_t{72}, std::size_t{100}}) {
+        auto corrupt = stream.str();
+        corrupt[offset] ^= 1;
+        auto corrupted = std::stringstream{corrupt};
+        REQUIRE_THROWS_AS(filter::load(corrupted), std::runtime_error);
+    }
+    auto truncated = std::stringstream{stream.str().substr(0, stream.str().size() - 8)};
+    REQUIRE_THROWS_AS(filter::load(truncated), std::runtime_error);
+
+#if defined(BF_HAS_MMAP)
+    const auto path = (std::filesystem::temp_directory_path() / "bf_compressed.bloom").string();
+    {
+        auto file = std::ofstream{path, std::ios::binary};
+        sparse.save(file, bf::Compression::elias_fano);
+    }
+    REQUIRE_THROWS_AS(bf::MappedBloomFilter<>{path}, std::runtime_error);
+    std::filesystem::remove(path);
+#endif
+}
+
+TEMPLATE_TEST_CASE("Save, load, and map blocked layouts", "[serialization][mmap][blocked][sbbf]",
+                   bf::BlockedBloomFilter<>, bf::SplitBlockBloomFilter<>) {
+    auto filter = TestType{10'000, 1e-3};
+    auto nums = std::vector<int>(20'000);
+    std::iota(nums.begin(), nums.end(), 0);
+    const auto inserted = std::span{nums}.first(10'000);
+    filter.insert_many(inserted);
+
+    for (const auto compression : {bf::Compression::none, bf::Compression::elias_fano}) {
+        auto stream = std::stringstream{};
+        filter.save(stream, compression);
+        const auto loaded = TestType::load(stream);
+        REQUIRE(loaded.search_many(nums) == filter.search_many(nums));
+    }
+
+    auto stream = std::stringstream{};
+    filter.save(stream);
+    auto standard = std::stringstream{stream.str()};
+    REQUIRE_THROWS_AS(bf::BloomFilter<>::load(standard), std::runtime_error);
+    auto standard_stream = std::stringstream{};
+    bf::BloomFilter{10'000, 1e-3}.save(standard_stream);
+    REQUIRE_THROWS_AS(TestType::load(standard_stream), std::runtime_error);
+
+#if defined(BF_HAS_MMAP)
+    using Mapped = std::conditional_t<std::is_same_v<TestType, bf::BlockedBloomFilter<>>,
+                                      bf::MappedBlockedBloomFilter<>,
+                                      bf::MappedSplitBlockBloomFilter<>>;
+    const auto path = (std::filesystem::temp_directory_path() / "bf_tests_blocked.bloom").string();
+    {
+        auto file = std::ofstream{path, std::ios::binary};
+        filter.save(file);
+    }
+    const auto mapped = Mapped{path, true};
+    REQUIRE(mapped.search_many(nums) == filter.search_many(nums));
+    for (const auto num : inserted) {
+        REQUIRE(mapped.search(num));
+    }
+    if constexpr (requires { filter.bytes(); }) {
+        REQUIRE(std::ranges::equal(mapped.bytes(), filter.bytes()));
+    }
+    std::filesystem::remove(path);
+#endif
+}
+
+TEST_CASE("XXH64 hasher", "[hasher][xxh64]") {
+    REQUIRE(bf::XXHash64{}(std::string_view{""}) == 0xef46db3751d8e999ULL);
+    REQUIRE(bf::XXHash64{}(std::string_view{"a"}) == 0xd24ec4f1a98c6e5bULL);
+    REQUIRE(bf::XXHash64{}(std::string_view{"abc"}) == 0x44bc2cf5ad770999ULL);
+    REQUIRE(bf::XXHash64{}(std::string_view{"Nobody inspects the spammish repetition"}) ==
+            0xfbcea83c8a378bf1ULL);
+    REQUIRE(bf::XXHash64{}(std::int32_t{1}) ==
+            bf::XXHash64{}(std::string_view{"\x01\x00\x00\x00", 4}));
+}
+
+TEST_CASE("Split-block insert and search", "[sbbf][insert][search]") {
+    auto bf = bf::SplitBlockBloomFilter{1000, 1e-2};
+
+    REQUIRE(std::has_single_bit(bf.bytes().size()));
+    REQUIRE(bf.bytes().size() == bf.blocks * bf::SplitBlockBloomFilter<>::block_bytes);
+
+    for (std::int64_t num = 0; num < 1000; num++) {
+        bf.insert(num);
+    }
+    auto positives = 0;
+    for (std::int64_t num = 0; num < 100'000; num++) {
+        if (num < 1000) {
+            REQUIRE(bf.search(num));
+        } else {
+            positives += static_cast<int>(bf.search(num));
+        }
+    }
+    REQUIRE(positives < 2 * 1e-2 * 100'000);
+
+    // Every key sets exactly one bit in every word of its block.
+    auto empty = bf::SplitBlockBloomFilter{1, 0.5};
+    empty.insert_hash(0x0123456789abcdefULL);
+    REQUIRE(empty.blocks == 1);
+    for (const auto word : empty.words) {
+        REQUIRE(std::popcount(word) == 1);
+    }
+
+#if defined(BF_HAS_X86_SIMD)
+    if (bf::simd() != bf::Simd::scalar) {
+        // The AVX2 kernel sets the same bits as the scalar definition of the mask.
+        constexpr auto& salts = bf::SplitBlockBloomFilter<>::salts;
+        alignas(32) std::array<std::uint32_t, 8> block{};
+        for (std::uint32_t key = 0; key < 1000; key++) {
+            block.fill(0);
+            bf::detail::split_block_insert_avx2(block.data(), key * 0x9e3779b9U, salts.data());
+            for (std::size_t idx = 0; idx < block.size(); idx++) {
+                REQUIRE(block[idx] == std::uint32_t{1} << ((key * 0x9e3779b9U * salts[idx]) >> 27));
+            }
+            REQUIRE(bf::detail::split_block_check_avx2(block.data(), key * 0x9e3779b9U,
+                                                        salts.data()));
+        }
+    }
+#endif
+
+    const auto copy = bf::SplitBlockBloomFilter{bf.bytes()};
+    REQUIRE(copy.words == bf.words);
+    for (std::int64_t num = 0; num < 1000; num++) {
+        REQUIRE(copy.search(num));
+    }
+    REQUIRE_THROWS_AS(bf::SplitBlockBloomFilter{bf.bytes().first(33)}, std::invalid_argument);
+
+    bf.clear();
+    REQUIRE(!bf.search(std::int64_t{1}));
+}
+
+TEST_CASE("Static insert and search", "[static][insert][search]") {
+    constexpr auto params = bf::static_parameters(1000, 1e-2);
+    const auto bf = bf::BloomFilter{1000, 1e-2};
+    STATIC_REQUIRE(params.bits > 0);
+    REQUIRE(params.bits == bf.bits);
+    REQUIRE(params.hash_fns == bf.hash_fns);
+    STATIC_REQUIRE(bf::static_parameters<bf::PowerOfTwo>(1000, 1e-2).bits == 16384);
+
+    using Filter = bf::StaticBloomFilter<params.bits, params.hash_fns>;
+    STATIC_REQUIRE(sizeof(Filter) == bf::BitArray::words_for(params.bits) * sizeof(std::uint64_t));
+
+    constexpr auto filter = [] {
+        auto res = Filter{};
+        for (int num = 0; num < 1000; num++) {
+            res.insert(num);
+        }
+        res.insert("hi");
+        return res;
+    }();
+    STATIC_REQUIRE(filter.search(0));
+    STATIC_REQUIRE(filter.search(999));
+    STATIC_REQUIRE(filter.search("hi"));
+
+    auto copy = filter;
+    auto positives = 0;
+    for (int num = 0; num < 100'000; num++) {
+        if (num < 1000) {
+            REQUIRE(copy.search(num));
+        } else {
+            positives += static_cast<int>(copy.search(num));
+        }
+    }
+    REQUIRE(positives < 2 * 1e-2 * 100'000);
+
+    // The static filter sets the same bits as the dynamic one.
+    auto dynamic = bf::BloomFilter{1000, 1e-2};
+    dynamic.insert_many(std::views::iota(0, 1000));
+    dynamic.insert("hi");
+    REQUIRE(std::equal(copy.words.begin(), copy.words.end(), dynamic.bvec.data()));
+
+    copy.clear();
+    REQUIRE(!copy.search(0));
+}
+
+TEST_CASE("Allocators", "[allocator]") {
+    SECTION("Arena") {
+        auto arena = std::pmr::monotonic_buffer_resource{};
+        auto bf = bf::pmr::BloomFilter<>{1000, 1e-2, {}, &arena};
+        REQUIRE(bf.bvec.get_allocator().upstream().resource() == &arena);
+        REQUIRE(reinterpret_cast<std::uintptr_t>(bf.bvec.data()) % bf::BitArray::alignment == 0);
+
+        bf.insert_many(std::views::iota(0, 1000));
+        for (int num = 0; num < 1000; num++) {
+            REQUIRE(bf.search(num));
+        }
+        bf.clear();
+        REQUIRE(bf.bvec.get_allocator().upstream().resource() == &arena);
+        REQUIRE(!bf.search(0));
+
+        auto stream = std::stringstream{};
+        bf.insert(1);
+        bf.save(stream);
+        const auto copy = bf::pmr::BloomFilter<>::load(stream, {}, &arena);
+        REQUIRE(copy.search(1));
+    }
+
+    SECTION("Counting resource") {
+        // Every allocation of the filter goes through the resource and is aligned to a cache line.
+        struct Counting : std::pmr::memory_resource {
+            std::size_t allocations = 0;
+            std::size_t alignment = 0;
+
+           private:
+            auto do_allocate(const std::size_t bytes, const std::size_t align) -> void* override {
+                allocations++;
+                alignment = align;
+                return std::pmr::new_delete_resource()->allocate(bytes, align);
+            }
+            void do_deallocate(void* ptr, const std::size_t bytes,
+                               const std::size_t align) override {
+                std::pmr::new_delete_resource()->deallocate(ptr, bytes, align);
+            }
+            [[nodiscard]] auto do_is_equal(const memory_resource& other) const noexcept
+                -> bool override {
+                return this == &other;
+            }
+        };
+        auto resource = Counting{};
+        {
+            const auto bf = bf::pmr::BloomFilter<>{1000, 1e-2, {}, &resource};
+            REQUIRE(resource.allocations == 1);
+            REQUIRE(resource.alignment == bf::BitArray::alignment);
+        }
+    }
+
+#if defined(BF_HAS_MMAP)
+    SECTION("Huge pages") {
+        using Allocator = bf::HugePageAllocator<std::uint64_t>;
+        auto bf = bf::BloomFilter<bf::DefaultHasher, bf::FastRange, Allocator>{100'000, 1e-2};
+        REQUIRE(reinterpret_cast<std::uintptr_t>(bf.bvec.data()) % 4096 == 0);
+        bf.insert_many(std::views::iota(0, 100'000));
+        for (int num = 0; num < 100'000; num++) {
+            REQUIRE(bf.search(num));
+        }
+    }
+#endif
+}
+
+TEST_CASE("Clear in place", "[clear]") {
+    auto bf = bf::BloomFilter{100'000, 1e-2};
+    const auto* data = bf.bvec.data();
+    bf.insert_many(std::views::iota(0, 100'000));
+    bf.clear();
+    REQUIRE(bf.bvec.data() == data);
+    REQUIRE(std::all_of(data, data + bf.bvec.words(), [](const auto word) { return word == 0; }));
+
+    // Large enough for non-temporal stores.
+    auto large = bf::BlockedBloomFilter{10'000'000, 1e-2};
+    REQUIRE(large.bvec.words() * sizeof(std::uint64_t) >= bf::detail::stream_bytes);
+    large.insert_many(std::views::iota(0, 100'000));
+    large.clear();
+    REQUIRE(std::all_of(large.bvec.data(), large.bvec.data() + large.bvec.words(),
+                        [](const auto word) { return word == 0; }));
+
+    auto pool = bf::ThreadPool{4};
+    large.insert_many(std::views::iota(0, 100'000));
+    large.clear(pool);
+    REQUIRE(std::all_of(large.bvec.data(), large.bvec.data() + large.bvec.words(),
+                        [](const auto word) { return word == 0; }));
+    bf.insert_many(std::views::iota(0, 100'000));
+    bf.clear(pool);
+    REQUIRE(!bf.search(0));
+}
+
+TEST_CASE("Epoch insert, search, and clear", "[epoch][clear]") {
+    auto bf = bf::EpochBloomFilter{10'000, 1e-2};
+    for (int round = 0; round < 3; round++) {
+        const auto offset = round * 10'000;
+        bf.insert_many(std::views::iota(offset, offset + 10'000));
+        for (int num = offset; num < offset + 10'000; num++) {
+            REQUIRE(bf.search(num));
+        }
+        auto positives = 0;
+        for (int num = offset + 10'000; num < offset + 110'000; num++) {
+            positives += static_cast<int>(bf.search(num));
+        }
+        REQUIRE(positives < 2 * 1e-2 * 100'000);
+
+        bf.clear();
+        REQUIRE(bf.epoch() == static_cast<std::uint32_t>(round + 1));
+        for (int num = offset; num < offset + 10'000; num++) {
+            REQUIRE(!bf.search(num));
+        }
+    }
+}
+
+TEST_CASE("Counting insert, erase, and search", "[counting][insert][erase][search]") {
+    auto bf = bf::CountingBloomFilter{10'000, 1e-2};
+    const auto plain = bf::BloomFilter{10'000, 1e-2};
+    REQUIRE(bf.counters == plain.bits);
+    REQUIRE(bf.hash_fns == plain.hash_fns);
+
+    bf.insert_many(std::views::iota(0, 10'000));
+    for (int num = 0; num < 10'000; num++) {
+        REQUIRE(bf.search(num));
+        REQUIRE(bf.count_estimate(num) >= 1);
+    }
+
+    // Erasing half of the elements keeps the other half and removes most of the erased ones.
+    for (int num = 0; num < 10'000; num += 2) {
+        REQUIRE(bf.erase(num));
+    }
+    auto positives = 0;
+    for (int num = 0; num < 10'000; num++) {
+        if (num % 2 == 1) {
+            REQUIRE(bf.search(num));
+        } else {
+            positives += static_cast<int>(bf.search(num));
+        }
+    }
+    REQUIRE(positives < 2 * 1e-2 * 5000);
+
+    // Counters saturate at 15 and saturated counters are never decremented.
+    auto counts = bf::CountingBloomFilter{100, 1e-2};
+    for (int idx = 0; idx < 20; idx++) {
+        counts.insert("hi");
+    }
+    REQUIRE(counts.count_estimate("hi") == bf::CountingBloomFilter<>::max_count);
+    for (int idx = 0; idx < 20; idx++) {
+        REQUIRE(counts.erase("hi"));
+    }
+    REQUIRE(counts.search("hi"));
+
+    counts.clear();
+    counts.insert("hi");
+    counts.insert("hi");
+    REQUIRE(counts.count_estimate("hi") == 2);
+    REQUIRE(counts.erase("hi"));
+    REQUIRE(counts.erase("hi"));
+    REQUIRE(!counts.search("hi"));
+    REQUIRE(!counts.erase("hi"));
+}
+
+TEST_CASE("Scalable insert and search", "[scalable][insert][search]") {
+    auto bf = bf::ScalableBloomFilter{1000, 1e-2};
+    REQUIRE(bf.layers().size() == 1);
+    REQUIRE(!bf.search(0));
+
+    bf.insert_many(std::views::iota(0, 100'000));
+    REQUIRE(bf.size() == 100'000);
+    // 1000 + 2000 + ... + 64000 < 100'000 <= 1000 + ... + 64000 + 128000.
+    REQUIRE(bf.layers().size() == 7);
+    REQUIRE(bf.layers().front().bits < bf.layers().back().bits);
+    REQUIRE(bf.fpr() < 1e-2);
+
+    for (int num = 0; num < 100'000; num++) {
+        REQUIRE(bf.search(num));
+    }
+    auto positives = 0;
+    for (int num = 100'000; num < 1'100'000; num++) {
+        positives += static_cast<int>(bf.search(num));
+    }
+    REQUIRE(positives < 1e-2 * 1'000'000);
+
+    bf.clear();
+    REQUIRE(bf.layers().size() == 1);
+    REQUIRE(bf.size() == 0);
+    REQUIRE(!bf.search(0));
+    REQUIRE_THROWS_AS(bf::ScalableBloomFilter(1000, 1.0), std::domain_error);
+}
+
+TEMPLATE_TEST_CASE("Binary fuse build and search", "[fuse][search]", std::uint8_t,
+                   std::uint16_t) {
+    const auto keys = std::views::iota(0, 100'000);
+    const auto bf = bf::BinaryFuseFilter<TestType>{keys};
+    REQUIRE(bf.fingerprints.size() < 1.2 * 100'000);
+
+    for (const auto key : keys) {
+        REQUIRE(bf.search(key));
+    }
+    auto positives = 0;
+    for (int num = 100'000; num < 1'100'000; num++) {
+        positives += static_cast<int>(bf.search(num));
+    }
+    const auto eps = std::ldexp(1.0, -static_cast<int>(8 * sizeof(TestType)));
+    REQUIRE(positives < 1.5 * eps * 1'000'000 + 20);
+
+    // Duplicates and tiny sets.
+    const auto dupes = std::vector<int>{1, 2, 2, 3, 3, 3};
+    const auto small = bf::BinaryFuseFilter<TestType>{dupes};
+    REQUIRE(small.search(1));
+    REQUIRE(small.search(2));
+    REQUIRE(small.search(3));
+    REQUIRE(bf::BinaryFuseFilter<TestType>{std::vector<int>{42}}.search(42));
+    REQUIRE(!bf::BinaryFuseFilter<TestType>{std::vector<int>{}}.fingerprints.empty());
+}
+
+TEST_CASE("Cuckoo insert, erase, and search", "[cuckoo][insert][erase][search]") {
+    auto bf = bf::CuckooFilter{100'000};
+    REQUIRE(bf.insert_many(std::views::iota(0, 100'000)));
+    REQUIRE(bf.size() == 100'000);
+    for (int num = 0; num < 100'000; num++) {
+        REQUIRE(bf.search(num));
+    }
+    auto positives = 0;
+    for (int num = 100'000; num < 1'100'000; num++) {
+        positives += static_cast<int>(bf.search(num));
+    }
+    REQUIRE(positives < 2 * 8.0 / 65536 * 1'000'000);
+
+    for (int num = 0; num < 100'000; num += 2) {
+        REQUIRE(bf.erase(num));
+    }
+    REQUIRE(bf.size() == 50'000);
+    for (int num = 1; num < 100'000; num += 2) {
+        REQUIRE(bf.search(num));
+    }
+
+    // A full filter sets one element aside and then refuses insertions.
+    auto full = bf::CuckooFilter{8};
+    auto inserted = 0;
+    while (full.insert(inserted)) {
+        inserted++;
+    }
+    REQUIRE(inserted > 8);
+    for (int num = 0; num < inserted; num++) {
+        REQUIRE(full.search(num));
+    }
+    REQUIRE(full.erase(0));
+    REQUIRE(full.insert(inserted));
+    full.clear();
+    REQUIRE(full.size() == 0);
+    REQUIRE(!full.search(1));
+}
+
+TEMPLATE_TEST_CASE("Merge and intersect", "[merge]", bf::BloomFilter<>, bf::BlockedBloomFilter<>) {
+    auto lhs = TestType{20'000, 1e-2};
+    auto rhs = TestType{20'000, 1e-2};
+    lhs.insert_many(std::views::iota(0, 10'000));
+    rhs.insert_many(std::views::iota(5000, 15'000));
+
+    auto both = TestType{20'000, 1e-2};
+    both.insert_many(std::views::iota(0, 15'000));
+    auto merged = lhs;
+    merged |= rhs;
+    REQUIRE(std::equal(merged.bvec.data(), merged.bvec.data() + merged.bvec.words(),
+                       both.bvec.data()));
+
+    auto intersected = lhs;
+    intersected &= rhs;
+    for (int num = 5000; num < 10'000; num++) {
+        REQUIRE(intersected.search(num));
+    }
+    auto positives = 0;
+    for (int num = 0; num < 5000; num++) {
+        positives += static_cast<int>(intersected.search(num));
+    }
+    REQUIRE(positives < 0.05 * 5000);
+
+    auto pool = bf::ThreadPool{4};
+    auto parallel = lhs;
+    parallel.merge(rhs, pool);
+    REQUIRE(std::equal(parallel.bvec.data(), parallel.bvec.data() + parallel.bvec.words(),
+                       merged.bvec.data()));
+    parallel = lhs;
+    parallel.intersect(rhs, pool);
+    REQUIRE(std::equal(parallel.bvec.data(), parallel.bvec.data() + parallel.bvec.words(),
+                       intersected.bvec.data()));
+
+    auto other = TestType{1000, 1e-2};
+    REQUIRE_THROWS_AS(lhs |= other, std::invalid_argument);
+    REQUIRE_THROWS_AS(lhs.merge(other, pool), std::invalid_argument);
+}
+
+TEST_CASE("Heterogeneous lookup", "[hasher][search]") {
+    const auto text = std::string{"a key in a receive buffer"};
+    const auto bytes = std::as_bytes(std::span{text});
+    const auto hasher = bf::DefaultHasher{};
+    REQUIRE(hasher(bytes) == hasher(text));
+    REQUIRE(hasher(std::string_view{text.data(), 5}) == hasher(bytes.first(5)));
+    REQUIRE(bf::XXHash64{}(bytes) == bf::XXHash64{}(std::string_view{text}));
+
+    auto bf = bf::BloomFilter{100, 1e-2};
+    bf.insert(text);
+    REQUIRE(bf.search(bytes));
+    REQUIRE(bf.search(std::string_view{text}));
+    REQUIRE(bf.search(text.c_str()));
+
+    // Ranges are taken by reference, so that ranges which cannot be copied can be inserted.
+    struct Keys {
+        std::vector<std::string> keys{"x", "y", "z"};
+        Keys() = default;
+        Keys(const Keys&) = delete;
+        auto operator=(const Keys&) -> Keys& = delete;
+        [[nodiscard]] auto begin() const {
+            return keys.begin();
+        }
+        [[nodiscard]] auto end() const {
+            return keys.end();
+        }
+    };
+    const auto keys = Keys{};
+    bf.insert_many(keys);
+    REQUIRE(bf.search_many(keys) == bf::bitvec{true, true, true});
+}
+
+TEST_CASE("Statistics and estimates", "[stats]") {
+    STATIC_REQUIRE(sizeof(bf::BloomFilter<>) ==
+                   sizeof(bf::BloomFilter<bf::DefaultHasher, bf::FastRange,
+                                          bf::AlignedAllocator<std::uint64_t>, bf::NoStats>));
+
+    using Filter = bf::BloomFilter<bf::DefaultHasher, bf::FastRange,
+                                   bf::AlignedAllocator<std::uint64_t>, bf::StripedStats>;
+    auto bf = Filter{10'000, 1e-2};
+    REQUIRE(bf.fill_ratio() == 0);
+    REQUIRE(bf.estimated_cardinality() == 0);
+    REQUIRE(bf.current_fpr_estimate() == 0);
+
+    bf.insert_many(std::views::iota(0, 10'000));
+    REQUIRE_THAT(bf.estimated_cardinality(), Catch::Matchers::WithinRel(10'000.0, 0.02));
+    REQUIRE_THAT(bf.fill_ratio(), Catch::Matchers::WithinRel(0.5, 0.05));
+    REQUIRE_THAT(bf.current_fpr_estimate(), Catch::Matchers::WithinRel(1e-2, 0.25));
+
+    for (int num = 0; num < 100; num++) {
+        REQUIRE(bf.search(num));
+    }
+    const auto many = bf.search_many(std::views::iota(0, 200));
+    REQUIRE(std::count(many.begin(), many.end(), true) >= 100);
+
+    auto pool = bf::ThreadPool{4};
+    bf.insert_many(pool, std::vector<int>(1000, 1));
+    const auto counts = bf.stats.counts();
+    REQUIRE(counts.inserts == 11'000);
+    REQUIRE(counts.searches == 300);
+    REQUIRE(counts.positives == 100 + static_cast<std::uint64_t>(
+                                          std::count(many.begin(), many.end(), true)));
+
+    const auto copy = bf;
+    REQUIRE(copy.stats.counts().inserts == 11'000);
+    bf.stats.reset();
+    REQUIRE(bf.stats.counts().searches == 0);
+}
+
+TEST_CASE("Partitioned insert and search", "[partitioned][insert][search]") {
+    REQUIRE(bf::numa::node_count() >= 1);
+#if defined(BF_HAS_NUMA)
+    REQUIRE(!bf::numa::node_cpus(0).empty());
+    REQUIRE(!bf::numa::pin_to_node(1u << 20));
+#endif
+
+    auto bf = bf::PartitionedBloomFilter{100'000, 1e-2, 8};
+    REQUIRE(bf.shards().size() == 8);
+    bf.insert_many(std::views::iota(0, 100'000));
+    for (int num = 0; num < 100'000; num++) {
+        REQUIRE(bf.search(num));
+    }
+    auto positives = 0;
+    for (int num = 100'000; num < 1'100'000; num++) {
+        positives += static_cast<int>(bf.search(num));
+    }
+    REQUIRE(positives < 1.5 * 1e-2 * 1'000'000);
+
+    // Every shard gets about an eighth of the elements.
+    for (const auto& shard : bf.shards()) {
+        REQUIRE_THAT(shard.estimated_cardinality(), Catch::Matchers::WithinRel(12'500.0, 0.1));
+    }
+
+    // A thread which owns a shard pins itself to the node of the shard.
+    auto thread = std::thread([&] {
+        bf.pin_to_shard(3);
+        bf.shards()[3].clear();
+    });
+    thread.join();
+    bf.clear();
+    REQUIRE(!bf.search(0));
+}
+
+TEST_CASE("Sliding window", "[sliding][insert][search]") {
+    auto bf = bf::SlidingBloomFilter{30'000, 1e-2, 3};
+    REQUIRE(bf.generations() == 3);
+    REQUIRE(bf.capacity() == 10'000);
+    REQUIRE_THROWS_AS((bf::SlidingBloomFilter{30'000, 1e-2, 8}), std::domain_error);
+
+    const auto positives = [&](const int begin, const int end) {
+        auto res = 0;
+        for (int num = begin; num < end; num++) {
+            res += static_cast<int>(bf.search(num));
+        }
+        return res;
+    };
+
+    // A full window holds three generations.
+    bf.insert_many(std::views::iota(0, 30'000));
+    REQUIRE(positives(0, 30'000) == 30'000);
+    REQUIRE(positives(1'000'000, 2'000'000) < 1.5 * 1e-2 * 1'000'000);
+
+    // Every generation pushes the oldest out of the window.
+    for (int gen = 3; gen < 10; gen++) {
+        bf.insert_many(std::views::iota(gen * 10'000, (gen + 1) * 10'000));
+        REQUIRE(positives((gen - 2) * 10'000, (gen + 1) * 10'000) == 30'000);
+        REQUIRE(positives((gen - 3) * 10'000, (gen - 2) * 10'000) < 0.02 * 10'000);
+        REQUIRE(positives(1'000'000, 1'100'000) < 1.5 * 1e-2 * 100'000);
+    }
+
+    // Ending generations early expires them as well.
+    bf.insert(-1);
+    bf.rotate();
+    bf.rotate();
+    REQUIRE(bf.search(-1));
+    bf.rotate();
+    REQUIRE(!bf.search(-1));
+
+    bf.insert(-1);
+    bf.clear();
+    REQUIRE(!bf.search(-1));
+}
+
+TEST_CASE("Register-blocked insert and search", "[register][insert][search]") {
+    using filter = bf::RegisterBlockedBloomFilter<>;
+    for (std::uint64_t fns = 1; fns <= filter::max_hash_fns; fns++) {
+        for (std::size_t idx = 0; idx < 2 * filter::pattern_count; idx++) {
+            const auto pattern = filter::patterns[fns][idx];
+            const auto odd = idx >= filter::pattern_count;
+            REQUIRE(static_cast<std::uint64_t>(std::popcount(pattern)) ==
+                    (odd ? fns / 2 : (fns + 1) / 2));
+            REQUIRE((pattern & (odd ? 0x5555555555555555ULL : 0xaaaaaaaaaaaaaaaaULL)) == 0);
+        }
+    }
+
+    // A filter of 4096 elements fits in 8 KB.
+    auto bf = filter{4096, 1e-2};
+    REQUIRE(bf.bits / 8 <= 8192);
+    bf.insert_many(std::views::iota(0, 4096));
+    for (int num = 0; num < 4096; num++) {
+        REQUIRE(bf.search(num));
+    }
+    auto positives = 0;
+    for (int num = 4096; num < 1'004'096; num++) {
+        positives += static_cast<int>(bf.search(num));
+    }
+    REQUIRE(positives < 1.5 * 1e-2 * 1'000'000);
+
+    bf.clear();
+    REQUIRE(!bf.search(0));
+}
+
+TEST_CASE("Register-blocked patterns are independent of the word", "[register][fpr]") {
+    // With more than 2^24 words, the low bits of the hash which select the word with `PowerOfTwo`
+    // reach past the 24th, which must not select the patterns as well.
+    constexpr std::uint64_t elems = 21'000'000;
+    constexpr std::uint64_t probes = 10'000'000;
+    auto bf = bf::RegisterBlockedBloomFilter<bf::DefaultHasher, bf::PowerOfTwo>{elems, 1e-4};
+    REQUIRE(bf.blocks > (std::size_t{1} << 24));
+    for (std::uint64_t num = 0; num < elems; num++) {
+        bf.insert(num);
+    }
+    std::uint64_t positives = 0;
+    for (std::uint64_t num = elems; num < elems + probes; num++) {
+        positives += static_cast<std::uint64_t>(bf.search(num));
+    }
+    const auto expected = decltype(bf)::fpr(elems, bf.blocks, bf.hash_fns);
+    const auto measured = static_cast<double>(positives) / static_cast<double>(probes);
+    REQUIRE(measured <= expected + 3 * std::sqrt(expected / static_cast<double>(probes)));
+}
+
+TEST_CASE("Fold and unfold", "[fold]") {
+    using filter = bf::BloomFilter<bf::DefaultHasher, bf::PowerOfTwo>;
+    constexpr auto foldable = []<typename F>(std::type_identity<F>) {
+        return requires(F& bf) { bf.fold(2); };
+    };
+    STATIC_REQUIRE(foldable(std::type_identity<filter>{}));
+    STATIC_REQUIRE(!foldable(std::type_identity<bf::BloomFilter<>>{}));
+
+    // A filter built for a million elements is folded to the ten thousand it holds.
+    auto bf = filter{1'000'000, 1e-2};
+    const auto bits = bf.bits;
+    bf.insert_many(std::views::iota(0, 10'000));
+    const auto factor = bf.fold_factor(2e-2);
+    REQUIRE(factor >= 32);
+    REQUIRE(factor <= 128);
+    REQUIRE_THROWS_AS(bf.fold(3), std::invalid_argument);
+    REQUIRE_THROWS_AS(bf.fold(2 * bits), std::invalid_argument);
+    REQUIRE_THROWS_AS(bf.unfold(0), std::invalid_argument);
+
+    bf.fold(factor);
+    REQUIRE(bf.bits == bits / factor);
+    for (int num = 0; num < 10'000; num++) {
+        REQUIRE(bf.search(num));
+    }
+    auto positives = 0;
+    for (int num = 10'000; num < 1'010'000; num++) {
+        positives += static_cast<int>(bf.search(num));
+    }
+    REQUIRE(positives < 1.2 * 2e-2 * 1'000'000);
+    REQUIRE_THAT(bf.estimated_cardinality(), Catch::Matchers::WithinRel(10'000.0, 0.05));
+
+    // Unfolding and folding again restores the bits.
+    bf.unfold(factor);
+    REQUIRE(bf.bits == bits);
+    for (int num = 0; num < 10'000; num++) {
+        REQUIRE(bf.search(num));
+    }
+    bf.fold(factor);
+    const auto folded =
+        std::vector<std::uint64_t>(bf.bvec.data(), bf.bvec.data() + bf.bvec.words());
+    bf.unfold(factor / 2);
+    bf.fold(factor / 2);
+    REQUIRE(std::equal(folded.begin(), folded.end(), bf.bvec.data()));
+    bf.insert(-1);
+    REQUIRE(bf.search(-1));
+
+    // Filters of less than a word are folded within it.
+    auto small = filter{6, 1e-2};
+    REQUIRE(small.bits == 64);
+    small.insert_many(std::views::iota(0, 6));
+    small.fold(4);
+    REQUIRE(small.bits == 16);
+    REQUIRE(small.bvec.data()[0] >> 16 == 0);
+    small.unfold(8);
+    REQUIRE(small.bits == 128);
+    for (int num = 0; num < 6; num++) {
+        REQUIRE(small.search(num));
+    }
+    small.fold(small.bits);
+    REQUIRE(small.bits == 1);
+    REQUIRE(small.search(100));
+}
+
+TEMPLATE_TEST_CASE("Interleaved async search", "[async][search]", bf::BloomFilter<>,
+                   bf::BlockedBloomFilter<>) {
+    auto bf = TestType{10'000, 1e-2};
+    bf.insert_many(std::views::iota(0, 10'000));
+    auto scheduler = bf::Interleaver{};
+
+    std::vector<std::uint8_t> found(20'000);
+    scheduler.for_each(found.size(), bf::prefetch_window, [&](const std::size_t idx) -> bf::Task<> {
+        found[idx] = static_cast<std::uint8_t>(
+            co_await bf.async_search(static_cast<int>(idx), scheduler));
+    });
+    for (std::size_t idx = 0; idx < found.size(); idx++) {
+        REQUIRE((found[idx] != 0) == bf.search(static_cast<int>(idx)));
+    }
+
+    // Lookups interleave with other coroutines which yield, such as the probes of a hash table.
+    const auto table = std::unordered_map<int, int>{{1, 10}, {2, 20}};
+    const auto lookup = [&](const int key) -> bf::Task<std::optional<int>> {
+        co_await scheduler.yield();
+        const auto it = table.find(key);
+        co_return it == table.end() ? std::nullopt : std::optional{it->second};
+    };
+    std::vector<int> joined;
+    const auto join = [&](const int key) -> bf::Task<> {
+        if (co_await bf.async_search(key, scheduler)) {
+            if (const auto value = co_await lookup(key)) {
+                joined.push_back(*value);
+            }
+        }
+    };
+    auto first = join(1);
+    auto second = join(2);
+    auto third = join(20'000'000);
+    scheduler.spawn(first);
+    scheduler.spawn(second);
+    scheduler.spawn(third);
+    scheduler.run();
+    REQUIRE(first.done());
+    REQUIRE(third.done());
+    REQUIRE(joined == std::vector<int>{10, 20});
+
+    // The first exception of a task stops the loop.
+    auto runs = 0;
+    REQUIRE_THROWS_AS(scheduler.for_each(100, 4,
+                                         [&](const std::size_t idx) -> bf::Task<> {
+                                             co_await scheduler.yield();
+                                             runs++;
+                                             if (idx == 10) {
+                                                 throw std::runtime_error("failed");
+                                             }
+                                         }),
+                      std::runtime_error);
+    REQUIRE(runs < 20);
+    REQUIRE(!scheduler.step());
+}